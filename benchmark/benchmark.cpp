@@ -65,7 +65,13 @@ namespace {
     }
 }
 
-void garbler(const Circuit& circuit, const std::string& host, const unsigned short port, const size_t iteration) {
+void garbler(
+    const Circuit& circuit,
+    const std::string& host,
+    const unsigned short port,
+    const size_t iteration,
+    const size_t threadCount
+) {
     ATLab::NetIO io {ATLab::NetIO::SERVER, host, port, false};
     rtt_test(io);
 
@@ -74,19 +80,25 @@ void garbler(const Circuit& circuit, const std::string& host, const unsigned sho
         io,
         circuit,
         zeroMasks,
-        {circuit.totalInputSize, ATLab::zero_block()}
+        {circuit.totalInputSize, ATLab::zero_block()},
+        threadCount
     )};
 
 BENCHMARK_INIT;
 BENCHMARK_START;
-    BlockCorrelatedOT::Sender::Initialize_simple_OT(io);
     for (size_t i {0}; i != iteration; ++i) {
         Garbler::online(io, circuit, gc, zeroMasks, Bitset{circuit.inputSize0, 0});
     }
 BENCHMARK_END_ITERATION(garbler online, iteration)
 }
 
-void evaluator(const Circuit& circuit, const std::string& host, const unsigned short port, const size_t iteration) {
+void evaluator(
+    const Circuit& circuit,
+    const std::string& host,
+    const unsigned short port,
+    const size_t iteration,
+    const size_t threadCount
+) {
     ATLab::NetIO io {ATLab::NetIO::CLIENT, host, port, false};
     rtt_test(io);
 
@@ -95,10 +107,9 @@ void evaluator(const Circuit& circuit, const std::string& host, const unsigned s
 
 BENCHMARK_INIT;
 BENCHMARK_START;
-    BlockCorrelatedOT::Receiver::Initialize_simple_OT(io);
-    const auto result {Evaluator::online(io, circuit, gc, zeroMasks, Bitset{circuit.inputSize1, 0})};
+    const auto result {Evaluator::online(io, circuit, gc, zeroMasks, Bitset{circuit.inputSize1, 0}, threadCount)};
     for (size_t i {1}; i != iteration; ++i) {
-        Evaluator::online(io, circuit, gc, zeroMasks, Bitset{circuit.inputSize1, 0});
+        Evaluator::online(io, circuit, gc, zeroMasks, Bitset{circuit.inputSize1, 0}, threadCount);
     }
 BENCHMARK_END_ITERATION(evaluator online, iteration);
     std::string output;
@@ -110,6 +121,7 @@ int main(int argc, char* argv[]) {
     std::string phase, host, role, circuitFile;
     unsigned short port;
     unsigned int iteration;
+    size_t threadCount;
 
     po::options_description desc {
         "Benchmark with inputs 0.\n"
@@ -122,7 +134,8 @@ int main(int argc, char* argv[]) {
         ("host", po::value(&host)->default_value("127.0.0.1"), "Garbler's listening IPv4 address")
         ("port,p", po::value(&port)->default_value(12345), "port")
         ("circuit,c", po::value(&circuitFile), "Path of the circuit file")
-        ("iteration,i", po::value(&iteration)->default_value(10), "Number of iterations");
+        ("iteration,i", po::value(&iteration)->default_value(10), "Number of iterations")
+        ("threads,t", po::value(&threadCount)->default_value(1), "Garbling/evaluation threads, 0 for all cores");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -160,9 +173,9 @@ int main(int argc, char* argv[]) {
 
     if (phase == "online") {
         if (role == "garbler") {
-            garbler(circuit, host, port, iteration);
+            garbler(circuit, host, port, iteration, threadCount);
         } else {
-            evaluator(circuit, host, port, iteration);
+            evaluator(circuit, host, port, iteration, threadCount);
         }
     } else if (phase == "pre") {
         if (role == "garbler") {
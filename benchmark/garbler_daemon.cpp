@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <ATLab/net-io.hpp>
+#include <ATLab/circuit_parser.hpp>
+#include <ATLab/2PC_execution.hpp>
+
+namespace po = boost::program_options;
+using namespace ATLab;
+
+namespace {
+    std::mutex coutMutex;
+
+    /**
+     * Runs `session(io)` on up to `workerCount` connections at a time until `sessionCount` sessions
+     * are done (0 for forever). Each worker owns one connection at a time, so the number of
+     * concurrent sessions, and their threads, stays bounded however many peers connect.
+     */
+    template<class ConnectFn, class SessionFn>
+    void run_sessions(
+        const size_t workerCount,
+        const size_t sessionCount,
+        ConnectFn connect,
+        SessionFn session
+    ) {
+        std::atomic<size_t> nextSession {0};
+        std::atomic<size_t> failedSessions {0};
+        const auto start {std::chrono::high_resolution_clock::now()};
+
+        std::vector<std::thread> workers;
+        for (size_t worker {0}; worker != workerCount; ++worker) {
+            workers.emplace_back([&]() {
+                while (true) {
+                    const size_t id {nextSession++};
+                    if (sessionCount != 0 && id >= sessionCount) {
+                        return;
+                    }
+                    try {
+                        const auto io {connect()};
+                        const auto sessionStart {std::chrono::high_resolution_clock::now()};
+                        session(*io);
+                        const auto sessionEnd {std::chrono::high_resolution_clock::now()};
+                        const std::lock_guard lock {coutMutex};
+                        std::cout << "session " << id << ": "
+                            << std::chrono::duration<double, std::milli>{sessionEnd - sessionStart}.count() << "ms\n";
+                    } catch (const std::exception& e) {
+                        ++failedSessions;
+                        const std::lock_guard lock {coutMutex};
+                        std::cerr << "session " << id << " failed: " << e.what() << '\n';
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        const auto end {std::chrono::high_resolution_clock::now()};
+        const double seconds {std::chrono::duration<double>{end - start}.count()};
+        std::cout << sessionCount << " sessions (" << failedSessions << " failed) in " << seconds << "s, "
+            << static_cast<double>(sessionCount - failedSessions) / seconds << " sessions/s\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string host, role, circuitFile;
+    unsigned short port;
+    size_t workerCount, sessionCount, threadCount;
+
+    po::options_description desc {
+        "Garbler serving concurrent full 2PC sessions with inputs 0, or evaluator clients driving it.\n"
+        "Options:"
+    };
+    desc.add_options()
+        ("help,h", "Show this help message")
+        ("role,r", po::value(&role)->default_value("garbler"), "garbler|evaluator")
+        ("host", po::value(&host)->default_value("127.0.0.1"), "Garbler's listening IPv4 address")
+        ("port,p", po::value(&port)->default_value(12345), "port")
+        ("circuit,c", po::value(&circuitFile), "Path of the circuit file")
+        ("workers,w", po::value(&workerCount)->default_value(4), "Maximum number of concurrent sessions")
+        ("sessions,s", po::value(&sessionCount)->default_value(0),
+            "Number of sessions before exiting, 0 to serve forever (garbler only)")
+        ("threads,t", po::value(&threadCount)->default_value(1), "Garbling/evaluation threads per session");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    if (vm.count("circuit") == 0) {
+        std::cerr << "No circuit file specified. Aborting...\n";
+        return 1;
+    }
+    if (role != "garbler" && role != "evaluator") {
+        std::cerr << "Invalid role. Aborting...\n";
+        return 1;
+    }
+    if (workerCount == 0) {
+        std::cerr << "At least one worker is needed. Aborting...\n";
+        return 1;
+    }
+    if (role == "evaluator" && sessionCount == 0) {
+        std::cerr << "Evaluators need a number of sessions. Aborting...\n";
+        return 1;
+    }
+
+    const Circuit circuit {circuitFile};
+    std::cout << "#AND gates: " << circuit.andGateSize << std::endl;
+
+    if (role == "garbler") {
+        NetIOListener listener {host, port};
+        std::cout << "listening on " << host << ':' << listener.port << std::endl;
+        run_sessions(
+            workerCount,
+            sessionCount,
+            [&listener]() {
+                return listener.accept();
+            },
+            [&circuit, threadCount](NetIO& io) {
+                Garbler::full_protocol(io, circuit, Bitset{circuit.inputSize0, 0}, threadCount);
+            }
+        );
+    } else {
+        run_sessions(
+            workerCount,
+            sessionCount,
+            [&host, port]() {
+                return std::make_unique<NetIO>(NetIO::CLIENT, host, port, true);
+            },
+            [&circuit, threadCount](NetIO& io) {
+                static_cast<void>(Evaluator::full_protocol(io, circuit, Bitset{circuit.inputSize1, 0}, threadCount));
+            }
+        );
+    }
+
+    return 0;
+}
@@ -106,5 +106,13 @@ if(ENABLE_BENCHMARK)
     add_compile_options(-DENABLE_BENCHMARK)
 endif(ENABLE_BENCHMARK)
 
+if(GARBLE_HASH_SHA256)
+    add_compile_options(-DGARBLE_HASH_SHA256)
+endif(GARBLE_HASH_SHA256)
+
+if(BCOT_BACKEND_FERRET)
+    add_compile_options(-DBCOT_BACKEND_FERRET)
+endif(BCOT_BACKEND_FERRET)
+
 # RDSEED
 include(${CMAKE_SOURCE_DIR}/cmake/enable_rdseed.cmake)
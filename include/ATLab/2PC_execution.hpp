@@ -19,6 +19,23 @@ namespace ATLab {
             const GarbledCircuit& gc
         );
 
+        // Input phase of `online`: only the labels of the input wires are used
+        void online_input(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const GarbledCircuit& gc,
+            const PreprocessedData& wireMasks,
+            const Bitset& input
+        );
+
+        // Output masks and GCCheck, the rest of `online`
+        void online_output(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const GarbledCircuit& gc,
+            const PreprocessedData& wireMasks
+        );
+
         void online(
             ATLab::NetIO& io,
             const Circuit& circuit,
@@ -27,16 +44,35 @@ namespace ATLab {
             const Bitset& input
         ) noexcept;
 
-        inline void full_protocol(ATLab::NetIO& io, const Circuit& circuit, Bitset input) {
+        /**
+         * The garbler is bound to its tables before the input phase, as if it sent them first: it sends
+         * their digest (see commit_garbled_tables), then streams them after the input phase, so that the
+         * evaluator consumes them while they arrive (see Evaluator::garble_and_evaluate) and checks them
+         * against the digest before the output phase. Streaming the tables themselves before the inputs
+         * would need the evaluator to buffer all of them. The circuit is garbled twice.
+         */
+        inline void full_protocol(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            Bitset input,
+            const size_t threadCount = 1
+        ) {
             input.resize(circuit.inputSize0);
             const auto wireMasks {preprocess(io, circuit)};
-            const auto gc {garble(io, circuit, wireMasks)};
-
-            online(io, circuit, gc, wireMasks, std::move(input));
+            auto inputLabels {gen_input_labels(circuit, wireMasks)};
+            commit_garbled_tables(io, circuit, wireMasks, inputLabels.label0, threadCount);
+            online_input(io, circuit, inputLabels, wireMasks, input);
+            const auto gc {garble(io, circuit, wireMasks, std::move(inputLabels.label0), threadCount)};
+            online_output(io, circuit, gc, wireMasks);
         }
 
-        inline void full_protocol(ATLab::NetIO& io, const std::string& circuitFile, const Bitset& input) {
-            full_protocol(io, Circuit{circuitFile}, input);
+        inline void full_protocol(
+            ATLab::NetIO& io,
+            const std::string& circuitFile,
+            const Bitset& input,
+            const size_t threadCount = 1
+        ) {
+            full_protocol(io, Circuit{circuitFile}, input, threadCount);
         }
     }
 
@@ -50,31 +86,64 @@ namespace ATLab {
             const Bitset& maskedValues
         );
 
+        // Input phase of `online`, returning the labels and masked values of the input wires
+        [[nodiscard]]
+        EvaluateResult online_input(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const PreprocessedData& wireMasks,
+            const Bitset& input
+        );
+
+        // Output masks and GCCheck, the rest of `online`
+        [[nodiscard]]
+        Bitset online_output(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const PreprocessedData& wireMasks,
+            const EvaluateResult& result
+        );
+
         [[nodiscard]]
         Bitset online(
             ATLab::NetIO& io,
             const Circuit& circuit,
             const ReceivedGarbledCircuit& gc,
             const PreprocessedData& wireMasks,
-            Bitset input
+            Bitset input,
+            size_t threadCount = 1
         );
 
         [[nodiscard]]
-        inline Bitset full_protocol(ATLab::NetIO& io, const Circuit& circuit, Bitset input) {
+        inline Bitset full_protocol(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            Bitset input,
+            const size_t threadCount = 1
+        ) {
 BENCHMARK_INIT;
 BENCHMARK_START;
             input.resize(circuit.inputSize1);
             const auto wireMasks {preprocess(io, circuit)};
 BENCHMARK_END(evaluator preprocessor);
-            const auto gc {garble(io, circuit)};
 BENCHMARK_START;
-            return online(io, circuit, gc, wireMasks, std::move(input));
+            const auto commitment {recv_garbled_tables_commitment(io)};
+            auto [inputMaskedValues, inputLabels] {online_input(io, circuit, wireMasks, input)};
+            const auto result {garble_and_evaluate(
+                io, circuit, wireMasks, std::move(inputLabels), std::move(inputMaskedValues), commitment, threadCount
+            )};
+            return online_output(io, circuit, wireMasks, result);
 BENCHMARK_END(evaluator online);
         }
 
         [[nodiscard]]
-        inline Bitset full_protocol(ATLab::NetIO& io, const std::string& circuitFile, Bitset input) {
-            return full_protocol(io, Circuit{circuitFile}, std::move(input));
+        inline Bitset full_protocol(
+            ATLab::NetIO& io,
+            const std::string& circuitFile,
+            Bitset input,
+            const size_t threadCount = 1
+        ) {
+            return full_protocol(io, Circuit{circuitFile}, std::move(input), threadCount);
         }
     }
 }
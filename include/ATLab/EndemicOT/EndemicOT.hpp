@@ -79,6 +79,10 @@ extern "C" {
         SenderMsg encrypt_with(const ReceiverMsg&) const;
     };
 
+    /**
+     * `length` OTs in one round: the receiver sends all its messages, then the sender answers all of them.
+     * Messages are buffered on the heap (several KB per OT).
+     */
     void batch_send(
         ATLab::NetIO&         io,
         const emp::block*   data0,
@@ -86,29 +90,9 @@ extern "C" {
         size_t              length
     );
 
-    // Stack allocation. Preferred.
     template <size_t LEN>
     void batch_send(ATLab::NetIO& io, const emp::block* data0, const emp::block* data1) {
-        // resetting the last 128 bits is not necessary since `recv` does not use those uninitialized bits
-        std::vector<Sender> senders;
-        senders.reserve(LEN);
-
-        for (size_t i{0}; i != LEN; ++i) {
-            // treat the first 128 bits of data0[i], data1[i] as Sender::Data
-            senders.emplace_back(
-                *reinterpret_cast<const Sender::Data*>(data0+i),
-                *reinterpret_cast<const Sender::Data*>(data1+i)
-            );
-        }
-
-        std::array<ReceiverMsg,LEN> rMsgs {};
-        io.recv_data(&rMsgs, sizeof(rMsgs));
-
-        std::array<SenderMsg,LEN> sMsgs;
-        for (size_t i {0}; i != LEN; ++i) {
-            sMsgs.at(i) = senders.at(i).encrypt_with(rMsgs.at(i));
-        }
-        io.send_data(sMsgs.data(), sizeof(SenderMsg) * LEN);
+        batch_send(io, data0, data1, LEN);
     }
 
 
@@ -119,27 +103,9 @@ extern "C" {
         size_t          length
     );
 
-    // Stack allocation. Preferred.
     template <size_t LEN>
     void batch_receive(ATLab::NetIO& io, emp::block* data, const bool* const choices) {
-        std::vector<Receiver> receivers;
-        receivers.reserve(LEN);
-        for (size_t i{0}; i != LEN; ++i) {
-            receivers.emplace_back(choices[i]);
-        }
-        std::array<ReceiverMsg,LEN> rMsgs {};
-        for (size_t i {0}; i != LEN; ++i) {
-            rMsgs.at(i) = receivers.at(i).get_receiver_msg();
-        }
-        io.send_data(&rMsgs, sizeof(rMsgs));
-
-        std::array<SenderMsg, LEN> sMsgs {};
-        io.recv_data(&sMsgs, sizeof(sMsgs));
-        for (size_t i {0}; i != LEN; ++i) {
-            auto& receiver {receivers.at(i)};
-            auto decryptedData {receiver.decrypt_chosen(sMsgs.at(i))};
-            memcpy(&data[i], &decryptedData, sizeof(__m128i));
-        }
+        batch_receive(io, data, choices, LEN);
     }
 }
 
@@ -81,6 +81,15 @@ typedef struct
 
 void gen_receiver_message(NewKyberOTRecver* recver, EndemicOTReceiverMsg* pks);
 void gen_sender_message(EndemicOTSenderMsg* ctxt, const NewKyberOTPtxt* ptxt, const EndemicOTReceiverMsg* recvPks);
+
+// 4 independent OTs per call, with the Kyber matrix expansion and noise sampling of the 4 done together
+void gen_receiver_message_x4(NewKyberOTRecver recver[4], EndemicOTReceiverMsg pks[4]);
+void gen_sender_message_x4(
+    EndemicOTSenderMsg ctxt[4],
+    const NewKyberOTPtxt ptxt[4],
+    const EndemicOTReceiverMsg recvPks[4]
+);
+
 void decrypt_received_data(NewKyberOTRecver* recver, const EndemicOTSenderMsg* ctxt);
 
 #endif // LIBOTE_NEWKYBEROT_H
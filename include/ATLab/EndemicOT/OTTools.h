@@ -51,4 +51,10 @@ void pkPlus(uint8_t* pk, const uint8_t* pk1, const uint8_t* pk2);
 
 void randomPK(uint8_t* pk, const uint8_t* seed1, const uint8_t* seed2);
 
+// 4 independent `pkHash`es, with the matrix expansion of the 4 done together
+void pkHash_x4(uint8_t* output[4], const uint8_t* pk[4], const uint8_t* pkSeed[4]);
+
+// 4 independent `randomPK`s
+void randomPK_x4(uint8_t* pk[4], const uint8_t* seed1[4], const uint8_t* seed2[4]);
+
 #endif //LIBOTE_OTTOOLS_H
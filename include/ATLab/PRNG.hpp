@@ -35,7 +35,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 namespace ATLab {
 
-    extern emp::PRG THE_GLOBAL_PRNG;
+    // One generator per thread, so that concurrent sessions never share PRG state
+    extern thread_local emp::PRG THE_GLOBAL_PRNG;
 
     // Deprecated. The `randombytes` used by Kyber is very slow
     // Singleton, since Kyber/rng.c uses a global variable to store the inner state
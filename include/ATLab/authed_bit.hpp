@@ -1,6 +1,7 @@
 #ifndef ATLab_AUTHED_BIT_HPP
 #define ATLab_AUTHED_BIT_HPP
 
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 #include <vector>
@@ -303,16 +304,14 @@ namespace ATLab {
             ITMacBits{bCOTReceiver, bitsToFix.size()}
         {
 
-            // Compute XOR between the generated bits and the bits to fix, store the result in fixedBits
-            // TODO: Compact the bool array to save communication
-            auto* diffArr = new bool[_bits.size()];
-            for (size_t i {0}; i < _bits.size(); ++i) {
-                diffArr[i] = _bits[i] ^ bitsToFix[i];
+            // Send the XOR between the generated bits and the bits to fix, packed
+#ifdef DEBUG
+            if (bitsToFix.size() != _bits.size()) {
+                throw std::invalid_argument{"Size mismatch between generated bits and bits to fix."};
             }
-            io.send_data(diffArr, sizeof(bool) * _bits.size());
-
+#endif // DEBUG
+            send_boost_bitset(io, _bits ^ bitsToFix);
             _bits = std::move(bitsToFix);
-            delete[] diffArr;
         }
 
         size_t size() const {
@@ -439,26 +438,26 @@ namespace ATLab {
         ITMacBitKeys(ATLab::NetIO& io, const BlockCorrelatedOT::Sender& bCOTSender, const size_t bitsSize):
             ITMacBitKeys{bCOTSender, bitsSize}
         {
-            auto* diffArr {new bool[bitsSize]};
-            io.recv_data(diffArr, sizeof(bool) * bitsSize);
-
-            std::vector<emp::block> masks;
-            masks.reserve(bitsSize);
-            for (size_t i {0}; i < bitsSize; ++i) {
-                // false => 0x0000...; true => 0xFFFF....
-                masks.push_back(_mm_set1_epi64x(-static_cast<uint64_t>(diffArr[i])));
-            }
+            std::vector<BitsetBlock> diffBlocks(calc_bitset_block(bitsSize));
+            io.recv_data(diffBlocks.data(), diffBlocks.size() * sizeof(BitsetBlock));
 
+            // local key ^= global key for set bits: the bit is broadcast to a mask, so the loop is branch-free
+            constexpr size_t bitsPerBlock {sizeof(BitsetBlock) * 8};
             for (size_t iterGlobalKey {0}; iterGlobalKey < _globalKeys.size(); ++iterGlobalKey) {
-                const emp::block& gk = _globalKeys[iterGlobalKey];
-                const size_t rowBase = iterGlobalKey * bitsSize;
-                for (size_t iterBit {0}; iterBit < bitsSize; ++iterBit) {
-                    emp::block& lk = _localKeys[rowBase + iterBit];
-                    lk = _mm_xor_si128(lk, _mm_and_si128(gk, masks[iterBit]));
+                const emp::block gk {_globalKeys[iterGlobalKey]};
+                emp::block* rowKeys {_localKeys.data() + iterGlobalKey * bitsSize};
+                for (size_t iterBlock {0}; iterBlock != diffBlocks.size(); ++iterBlock) {
+                    const BitsetBlock word {diffBlocks[iterBlock]};
+                    const size_t
+                        blockBegin {iterBlock * bitsPerBlock},
+                        blockBits {std::min(bitsPerBlock, bitsSize - blockBegin)};
+                    emp::block* keys {rowKeys + blockBegin};
+                    for (size_t iterBit {0}; iterBit != blockBits; ++iterBit) {
+                        const auto bit {static_cast<int64_t>((word >> iterBit) & 1)};
+                        keys[iterBit] = _mm_xor_si128(keys[iterBit], _mm_and_si128(gk, _mm_set1_epi64x(-bit)));
+                    }
                 }
             }
-
-            delete[] diffArr;
         }
 
         // size of bits authenticated
@@ -1,107 +1,109 @@
 #ifndef ATLab_CORRELATED_OT_HPP
 #define ATLab_CORRELATED_OT_HPP
 
+#include <algorithm>
+#include <tuple>
 #include <utility>
 #include <vector>
 #include <memory>
 #include <stdexcept>
 #include <array>
 #include <emp-tool/utils/block.h>
-#include <emp-ot-original/iknp.h>
 
+#include "cot_backend.hpp"
+#include "fixed_key_aes.hpp"
+#include "session.hpp"
 #include "utils.hpp"
 #include "PRNG.hpp"
 
-#ifndef PARTY_INSTANCES_PER_THREAD
-#define PARTY_INSTANCES_PER_THREAD 1 // Always keep this at 1 outside single-process testing.
-#endif
-static_assert(PARTY_INSTANCES_PER_THREAD == 1 || PARTY_INSTANCES_PER_THREAD == 2,
-    "PARTY_INSTANCES_PER_THREAD must be 1 (production) or 2 (single-process testing only)");
-
-// using IKNP
+// using the COT backend of cot_backend.hpp, IKNP by default
 namespace ATLab::BlockCorrelatedOT {
 
-    using OT = emp::IKNP<NetIO>;
+    /**
+     * Tweak separating the hash of the j-th OT for the i-th delta.
+     * Breaks the correlation with the backend's own Δ before re-correlating with a bCOT Δ.
+     */
+    inline emp::block cot_tweak(const size_t deltaIndex, const size_t otIndex) noexcept {
+        return _mm_set_epi64x(static_cast<int64_t>(deltaIndex), static_cast<int64_t>(otIndex));
+    }
+
+    /**
+     * Blocks (OTs times deltas) extended at once into the pool of a Sender/Receiver.
+     * Requests smaller than a pool batch are served from the pool, so that runs of small requests
+     * cost one extension round trip per batch. Both parties must use the same pool size.
+     */
+    constexpr size_t COT_POOL_SIZE {4096};
+
+    // Copies OTs [cursor, cursor + len) of every delta from a key-major array of `from` OTs per delta
+    inline void copy_ots(
+        const emp::block* src,
+        const size_t from,
+        const size_t cursor,
+        emp::block* dst,
+        const size_t to,
+        const size_t offset,
+        const size_t len,
+        const size_t deltaArrSize
+    ) noexcept {
+        for (size_t i {0}; i != deltaArrSize; ++i) {
+            std::copy_n(src + i * from + cursor, len, dst + i * to + offset);
+        }
+    }
 
     class Sender {
         const std::vector<emp::block> _deltaArr;
-#if PARTY_INSTANCES_PER_THREAD == 1
-        static std::unique_ptr<OT>& shared_ot_storage() {
-            static std::unique_ptr<OT> instance;
-            return instance;
-        }
-#else
-        static std::array<std::unique_ptr<OT>, PARTY_INSTANCES_PER_THREAD>& shared_ot_storage() {
-            static std::array<std::unique_ptr<OT>, PARTY_INSTANCES_PER_THREAD> instances;
-            return instances;
-        }
+        COTSenderBackend& _cot;
 
-        static size_t role_index(const NetIO::Role role) {
-            const auto index = static_cast<size_t>(role);
-            if (index >= PARTY_INSTANCES_PER_THREAD) {
-                throw std::logic_error{"Unexpected NetIO role index for BlockCorrelatedOT sender"};
-            }
-            return index;
-        }
-#endif
+        // OTs per delta of a pool refill, 0 if pooling is off
+        const size_t _poolBatch;
+        // Unused keys are [_poolCursor, _poolLen) of each delta
+        mutable std::vector<emp::block> _pool;
+        mutable size_t _poolLen {0}, _poolCursor {0};
 
     public:
-        static OT& Initialize_simple_OT(ATLab::NetIO& io) {
-#if PARTY_INSTANCES_PER_THREAD == 1
-            auto& instance = shared_ot_storage();
-#else
-            auto& instance = shared_ot_storage().at(role_index(io.role));
-#endif
-            if (!instance) {
-                instance = std::make_unique<OT>(&io, true);
-                instance->setup_send();
-            } else if (instance->io != &io) {
-                throw std::runtime_error{"Shared IKNP sender OT already bound to a different NetIO"};
-            }
-            return *instance;
-        }
-
-        static OT& Get_simple_OT(const NetIO::Role role) {
-#if PARTY_INSTANCES_PER_THREAD == 1
-            auto& instance = shared_ot_storage();
-#else
-            const auto& instance = shared_ot_storage().at(role_index(role));
-#endif
-            if (!instance) {
-                throw std::logic_error{"Shared IKNP sender OT is not initialized"};
-            }
-            return *instance;
-        }
-
         const NetIO::Role role;
         const size_t deltaArrSize;
-        Sender(ATLab::NetIO& io, std::vector<emp::block> deltaArr) :
+
+        /**
+         * Extends from the COT sender backend of the session of `io`
+         * @param poolSize blocks held by the pool of random OTs, 0 to extend every request on its own
+         */
+        Sender(ATLab::NetIO& io, std::vector<emp::block> deltaArr, const size_t poolSize = COT_POOL_SIZE) :
             _deltaArr(std::move(deltaArr)),
+            _cot {io.session().cot_sender()},
+            _poolBatch {_deltaArr.empty() ? 0 : poolSize / _deltaArr.size()},
             role {io.role},
             deltaArrSize {_deltaArr.size()}
-        {
-            Initialize_simple_OT(io);
-        }
+        {}
 
         /**
-         *
+         * Random OTs, taken from the pool while it lasts, then from a refill if the rest is smaller than
+         * a batch, otherwise from a dedicated extension. The receiver takes the same path.
          * @param len the returned OT length of each delta
          * @return The size is `len * _deltaArrSize`. Arrange: key major
          * The j-th key corresponding to the i-th delta is placed at the position `j + i * len` (counting from 0).
          */
         std::vector<emp::block> extend(const size_t len) const {
-            const size_t otSize {len * _deltaArr.size()};
-            std::vector<emp::block> k1Vec(otSize), k2Vec(otSize);
-            for (auto& k1 : k1Vec) {
-                k1 = _mm_set_epi64x(THE_GLOBAL_PRNG(), THE_GLOBAL_PRNG());
+            const size_t pooled {std::min(len, _poolLen - _poolCursor)};
+            if (pooled == 0 && len >= _poolBatch) {
+                return _extend(len);
             }
-            for (size_t i {0}; i != _deltaArr.size(); ++i) {
-                for (size_t j {0}; j != len; ++j) {
-                    k2Vec.at(i * len + j) = k1Vec.at(i * len + j) ^ _deltaArr.at(i);
-                }
+
+            std::vector<emp::block> keys(len * _deltaArr.size());
+            copy_ots(_pool.data(), _poolLen, _poolCursor, keys.data(), len, 0, pooled, _deltaArr.size());
+            _poolCursor += pooled;
+
+            const size_t rest {len - pooled};
+            if (rest >= _poolBatch) {
+                const auto restKeys {_extend(rest)};
+                copy_ots(restKeys.data(), rest, 0, keys.data(), len, pooled, rest, _deltaArr.size());
+            } else if (rest != 0) {
+                _pool = _extend(_poolBatch);
+                _poolLen = _poolBatch;
+                copy_ots(_pool.data(), _poolLen, 0, keys.data(), len, pooled, rest, _deltaArr.size());
+                _poolCursor = rest;
             }
-            Get_simple_OT(role).send(k1Vec.data(), k2Vec.data(), static_cast<int64_t>(otSize));
-            return k1Vec;
+            return keys;
         }
 
         const emp::block& get_delta(const size_t i) const {
@@ -111,84 +113,120 @@ namespace ATLab::BlockCorrelatedOT {
         const std::vector<emp::block>& get_delta_arr() const {
             return _deltaArr;
         }
-    };
 
-    class Receiver {
-#if PARTY_INSTANCES_PER_THREAD == 1
-        static std::unique_ptr<OT>& shared_ot_storage() {
-            static std::unique_ptr<OT> instance;
-            return instance;
-        }
-#else
-        static std::array<std::unique_ptr<OT>, PARTY_INSTANCES_PER_THREAD>& shared_ot_storage() {
-            static std::array<std::unique_ptr<OT>, PARTY_INSTANCES_PER_THREAD> instances;
-            return instances;
-        }
-
-        static size_t role_index(const NetIO::Role role) {
-            const auto index = static_cast<size_t>(role);
-            if (index >= PARTY_INSTANCES_PER_THREAD) {
-                throw std::logic_error{"Unexpected NetIO role index for BlockCorrelatedOT receiver"};
+    private:
+        /**
+         * Vector-Δ correlated OT: one backend COT per bit carries all L deltas.
+         * The backend outputs q_j, and the receiver holds q_j ^ b_j Δ_COT.
+         * The key for Δ_i is H(q_j, (i, j)), and one correction H(q_j, (i, j)) ^ H(q_j ^ Δ_COT, (i, j)) ^ Δ_i is sent.
+         */
+        std::vector<emp::block> _extend(const size_t len) const {
+            const size_t otSize {len * _deltaArr.size()};
+            const emp::block cotDelta {_cot.delta()};
+
+            std::vector<emp::block> qArr(len);
+            _cot.send_cot(qArr.data(), len);
+
+            std::vector<emp::block> keys(otSize), corrections(otSize);
+            for (size_t j {0}; j != len; ++j) {
+                const TCCRHasher hash0 {qArr[j]}, hash1 {qArr[j] ^ cotDelta};
+                for (size_t i {0}; i != _deltaArr.size(); ++i) {
+                    const size_t index {i * len + j};
+                    const emp::block tweak {cot_tweak(i, j)};
+                    keys[index] = hash0(tweak);
+                    corrections[index] = keys[index] ^ hash1(tweak) ^ _deltaArr[i];
+                }
             }
-            return index;
+            _cot.simple_ot().io->send_data(corrections.data(), otSize * sizeof(emp::block));
+            return keys;
         }
-#endif
+    };
 
-    public:
-        static OT& Initialize_simple_OT(ATLab::NetIO& io) {
-#if PARTY_INSTANCES_PER_THREAD == 1
-            auto& instance = shared_ot_storage();
-#else
-            auto& instance = shared_ot_storage().at(role_index(io.role));
-#endif
-            if (!instance) {
-                instance = std::make_unique<OT>(&io, true);
-                instance->setup_recv();
-            } else if (instance->io != &io) {
-                throw std::runtime_error{"Shared IKNP receiver OT already bound to a different NetIO"};
-            }
-            return *instance;
-        }
+    class Receiver {
+        COTReceiverBackend& _cot;
 
-        static OT& Get_simple_OT(const NetIO::Role role) {
-#if PARTY_INSTANCES_PER_THREAD == 1
-            auto& instance = shared_ot_storage();
-#else
-            const auto& instance = shared_ot_storage().at(role_index(role));
-#endif
-            if (!instance) {
-                throw std::logic_error{"Shared IKNP receiver OT is not initialized"};
-            }
-            return *instance;
-        }
+        const size_t _poolBatch;
+        mutable Bitset _poolChoices;
+        mutable std::vector<emp::block> _poolMacs;
+        mutable size_t _poolCursor {0};
 
+    public:
         const size_t deltaArrSize; // L
         const NetIO::Role role;
 
-        Receiver(ATLab::NetIO& io, const size_t deltaArrSize) :
+        /**
+         * Extends from the COT receiver backend of the session of `io`
+         * @param poolSize must equal the sender's
+         */
+        Receiver(ATLab::NetIO& io, const size_t deltaArrSize, const size_t poolSize = COT_POOL_SIZE) :
+            _cot {io.session().cot_receiver()},
+            _poolBatch {deltaArrSize ? poolSize / deltaArrSize : 0},
             deltaArrSize {deltaArrSize},
             role {io.role}
-        {
-            Initialize_simple_OT(io);
-        }
+        {}
 
+        // Mirrors Sender::extend
         std::tuple<Bitset, std::vector<emp::block>> extend(const size_t len) const {
+            const size_t poolLen {_poolChoices.size()};
+            const size_t pooled {std::min(len, poolLen - _poolCursor)};
+            if (pooled == 0 && len >= _poolBatch) {
+                return _extend(len);
+            }
+
+            Bitset choices(len);
+            std::vector<emp::block> macs(len * deltaArrSize);
+            auto take {[&](const Bitset& srcChoices, const std::vector<emp::block>& srcMacs, const size_t cursor,
+                const size_t offset, const size_t count) {
+                for (size_t j {0}; j != count; ++j) {
+                    choices[offset + j] = srcChoices[cursor + j];
+                }
+                copy_ots(srcMacs.data(), srcChoices.size(), cursor, macs.data(), len, offset, count, deltaArrSize);
+            }};
+            take(_poolChoices, _poolMacs, _poolCursor, 0, pooled);
+            _poolCursor += pooled;
+
+            const size_t rest {len - pooled};
+            if (rest >= _poolBatch) {
+                const auto [restChoices, restMacs] {_extend(rest)};
+                take(restChoices, restMacs, 0, pooled, rest);
+            } else if (rest != 0) {
+                std::tie(_poolChoices, _poolMacs) = _extend(_poolBatch);
+                take(_poolChoices, _poolMacs, 0, pooled, rest);
+                _poolCursor = rest;
+            }
+            return {std::move(choices), std::move(macs)};
+        }
+
+    private:
+        std::tuple<Bitset, std::vector<emp::block>> _extend(const size_t len) const {
             const size_t otSize{len * deltaArrSize};
-            Bitset choices{random_dynamic_bitset(len)};
-            std::vector<emp::block> macArr(otSize);
 
+            // One random COT per bit, shared by all deltas
+            std::vector<emp::block> tArr(len);
             // Use regular bool array instead of vector<bool>
-            bool* choicesForOT = new bool[otSize];
-            // repeatedly copy choices to choicesForOT
-            for (size_t i{0}; i != deltaArrSize; ++i) {
-                for (size_t j = 0; j < len; ++j) {
-                    choicesForOT[i * len + j] = choices[j];
-                }
+            std::unique_ptr<bool[]> choicesForOT {new bool[len]};
+            _cot.recv_cot(tArr.data(), choicesForOT.get(), len);
+
+            Bitset choices(len);
+            for (size_t j {0}; j != len; ++j) {
+                choices.set(j, choicesForOT[j]);
             }
 
-            Get_simple_OT(role).recv(macArr.data(), choicesForOT, static_cast<int64_t>(otSize));
+            std::vector<emp::block> corrections(otSize);
+            _cot.simple_ot().io->recv_data(corrections.data(), otSize * sizeof(emp::block));
+
+            std::vector<emp::block> macArr(otSize);
+            for (size_t j {0}; j != len; ++j) {
+                const TCCRHasher hash {tArr[j]};
+                for (size_t i {0}; i != deltaArrSize; ++i) {
+                    const size_t index {i * len + j};
+                    macArr[index] = hash(cot_tweak(i, j));
+                    if (choicesForOT[j]) {
+                        xor_to(macArr[index], corrections[index]);
+                    }
+                }
+            }
 
-            delete[] choicesForOT;
             return {choices, macArr};
         }
     };
@@ -4,11 +4,12 @@
 #include <algorithm>
 #include <limits>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <sys/stat.h>
 
+#include <boost/core/span.hpp>
+
 #include "utils.hpp"
 #include "matrix.hpp"
 
@@ -16,37 +17,36 @@
 namespace ATLab {
 	using Wire = int32_t;
 
+	/**
+	 * The independent wires XORed into a wire, sorted ascending, plus whether the XOR result is flipped by NOT gates.
+	 * A view into XORSourceMatrix; it must not outlive the circuit.
+	 */
 	class XORSourceList {
-		Matrix<bool>::RowView _row;
+		boost::span<const Wire> _wires;
 		const bool _flip;
 
-		[[nodiscard]]
-		size_t _block_count() const noexcept {
-			return _row.block_count();
-		}
-
 	public:
 		XORSourceList() = delete;
 
 		XORSourceList(
-			Matrix<bool>::RowView row,
+			boost::span<const Wire> wires,
 			const bool flip
 		) noexcept:
-			_row {std::move(row)},
+			_wires {wires},
 			_flip {flip}
 		{}
 
 		[[nodiscard]]
-		const Matrix<bool>::RowView& row() const & noexcept {
-			return _row;
+		boost::span<const Wire> wires() const noexcept {
+			return _wires;
 		}
 
-		// Sequential
+		// Sequential, in ascending wire order
 		template <class Func>
 		void for_each_wire(Func&& fn) const {
-			return _row.for_each_set_bit([func = std::forward<Func>(fn)](const size_t col) {
-				func(static_cast<Wire>(col));
-			});
+			for (const Wire w : _wires) {
+				fn(w);
+			}
 		}
 
 		bool has(const Wire wire) const {
@@ -57,18 +57,18 @@ namespace ATLab {
 				throw std::invalid_argument{sout.str()};
 			}
 #endif // DEBUG
-			const size_t column {static_cast<size_t>(wire)};
-			return _row.test(column);
+			return std::binary_search(_wires.begin(), _wires.end(), wire);
 		}
 
 		[[nodiscard]]
 		bool empty() const noexcept {
-			return _row.empty();
+			return _wires.empty();
 		}
 
+		// Number of source wires
 		[[nodiscard]]
 		size_t size() const noexcept {
-			return _row.column_size();
+			return _wires.size();
 		}
 
 		bool test_flip() const noexcept {
@@ -76,24 +76,24 @@ namespace ATLab {
 		}
 	};
 
+	/**
+	 * Sparse rows of XOR sources, one per wire.
+	 * Every row is a sorted range [_rowBegin[w], _rowBegin[w] + _rowLength[w]) in the shared pool `_sources`.
+	 * Rows are appended in gate order, so memory grows with the total support size instead of wireSize^2.
+	 * A NOT gate reuses the range of its input wire.
+	 */
 	class XORSourceMatrix {
 		friend class Circuit;
-		using MatrixBlock = Matrix<bool>::Block64;
 
-		Matrix<bool> _mat;
+		std::vector<Wire> _sources;
+		std::vector<size_t> _rowBegin;
+		std::vector<size_t> _rowLength;
 		Bitset _flip;
 
-		void _set_positive_bit(const size_t row, const size_t column) noexcept {
-			assert(row < row_size() && column < col_size());
-
-			const size_t blockIndex {column / Matrix<bool>::bits_per_block};
-			const size_t bitOffset {column % Matrix<bool>::bits_per_block};
-			MatrixBlock* rowData {_mat.row_data(row)};
-			rowData[blockIndex] |= (MatrixBlock{1} << bitOffset);
-		}
-
 		void _initialize(const size_t wireSize) {
-			_mat = Matrix<bool>{wireSize, wireSize};
+			_sources.clear();
+			_rowBegin.assign(wireSize, 0);
+			_rowLength.assign(wireSize, 0);
 			_flip.resize(wireSize);
 		}
 
@@ -103,31 +103,43 @@ namespace ATLab {
 			const auto wireSize {static_cast<Wire>(row_size())};
 			assert(out < wireSize && in0 < wireSize && in1 < wireSize);
 
-			const size_t blockCount {_mat.blocks_per_row()};
-			MatrixBlock* outRow {_mat.row_data(out)};
-			const MatrixBlock* in0Row {_mat.row_data(in0)};
-			const MatrixBlock* in1Row {_mat.row_data(in1)};
-
-			for (size_t i {0}; i < blockCount; ++i) {
-				outRow[i] = in0Row[i] ^ in1Row[i];
+			// Symmetric difference of two sorted rows. Indices stay valid while `_sources` grows.
+			size_t
+				i0 {_rowBegin[in0]}, end0 {i0 + _rowLength[in0]},
+				i1 {_rowBegin[in1]}, end1 {i1 + _rowLength[in1]};
+			const size_t begin {_sources.size()};
+			while (i0 != end0 && i1 != end1) {
+				const Wire w0 {_sources[i0]}, w1 {_sources[i1]};
+				if (w0 < w1) {
+					_sources.push_back(w0);
+					++i0;
+				} else if (w1 < w0) {
+					_sources.push_back(w1);
+					++i1;
+				} else {
+					++i0;
+					++i1;
+				}
+			}
+			for (; i0 != end0; ++i0) {
+				_sources.push_back(_sources[i0]);
 			}
+			for (; i1 != end1; ++i1) {
+				_sources.push_back(_sources[i1]);
+			}
+
+			_rowBegin[out] = begin;
+			_rowLength[out] = _sources.size() - begin;
 			_flip.set(out, _flip.test(in0) ^ _flip.test(in1));
 		}
 
 		void _assign_not(const Wire out, const Wire in) {
-			/**
-			 * When the input wire has a non-empty negative list, XOR the two lists into the positive list.
-			 * Otherwise, out' negative list <- in's positive list
-			 */
 			const auto wireSize {static_cast<Wire>(row_size())};
 			assert(out >= 0 && in >= 0);
 			assert(out < wireSize && in < wireSize);
 
-			const size_t blockCount {_mat.blocks_per_row()};
-			MatrixBlock* outRow {_mat.row_data(out)};
-			const MatrixBlock* inRow {_mat.row_data(in)};
-
-			std::copy_n(inRow, blockCount, outRow);
+			_rowBegin[out] = _rowBegin[in];
+			_rowLength[out] = _rowLength[in];
 			_flip.set(out, !_flip.test(in));
 		}
 
@@ -138,31 +150,37 @@ namespace ATLab {
 			const size_t row {static_cast<size_t>(wire)};
 			assert(wire >= 0 && row < row_size());
 
-			_set_positive_bit(row, row);
+			_rowBegin[row] = _sources.size();
+			_rowLength[row] = 1;
+			_sources.push_back(wire);
 		}
 
 		[[nodiscard]]
 		XORSourceList row(const Wire wire) const noexcept {
 			assert(wire >= 0 && wire < static_cast<Wire>(row_size()));
 
-			return XORSourceList{_mat.row(wire), _flip.test(wire)};
+			return XORSourceList{
+				boost::span<const Wire>{_sources.data() + _rowBegin[wire], _rowLength[wire]},
+				_flip.test(wire)
+			};
 		}
 
 		[[nodiscard]]
 		size_t row_size() const noexcept {
-			return _mat.rowSize;
+			return _rowBegin.size();
 		}
 
+		// Total number of stored source entries
 		[[nodiscard]]
-		size_t col_size() const noexcept {
-			return _mat.colSize;
+		size_t support_size() const noexcept {
+			return _sources.size();
 		}
 	};
 
 	struct Gate {
 		static constexpr Wire DISABLED {-1};
 
-		enum class Type {
+		enum class Type : uint8_t {
 			AND, XOR, NOT
 		};
 
@@ -192,18 +210,80 @@ namespace ATLab {
 		}
 	};
 
+	/**
+	 * Structure-of-arrays copy of `Circuit::gates`, indexed by gate index:
+	 * gate i reads in0[i] (and in1[i] unless NOT) and writes out[i].
+	 * Hot loops stream these 13 bytes per gate instead of the padded `Gate` records.
+	 */
+	struct GateArrays {
+		std::vector<Gate::Type> types;
+		std::vector<Wire> in0, in1, out;
+
+		[[nodiscard]]
+		size_t size() const noexcept {
+			return types.size();
+		}
+
+		[[nodiscard]]
+		bool is_and(const size_t gateIndex) const noexcept {
+			return types[gateIndex] == Gate::Type::AND;
+		}
+	};
+
+	/**
+	 * Gates of one AND-depth level, as gate indices in circuit order.
+	 * The linear (XOR and NOT) gates must be processed first, in order; the AND gates then only depend on
+	 * earlier levels and these linear gates, and are independent of each other.
+	 */
+	struct CircuitLevel {
+		boost::span<const size_t> linearGates, andGates;
+	};
+
+	/**
+	 * AND gates whose input XOR source lists contain one independent wire, in AND order.
+	 * `connections[k]` has GC_CHECK_IN0 set if the wire is a source of in0 of AND gate `andOrders[k]`,
+	 * and GC_CHECK_IN1 if it is a source of in1.
+	 */
+	struct GCCheckRow {
+		static constexpr uint8_t GC_CHECK_IN0 {1}, GC_CHECK_IN1 {2};
+
+		boost::span<const uint32_t> andOrders;
+		boost::span<const uint8_t> connections;
+
+		[[nodiscard]]
+		size_t size() const noexcept {
+			return andOrders.size();
+		}
+	};
+
 	class Circuit {
 		std::vector<size_t> _andGateOrder;
 		std::vector<size_t> _andToGlobalIndex; // inverse of _andGateOrder
 		XORSourceMatrix _xorSourceMatrix;
-		std::unordered_map<Wire, size_t> _outputWireToGateIndex;
+		std::vector<uint32_t> _outputWireToGateIndex; // size: wireSize, NO_SOURCE_GATE for input wires
+
+		// GC-check connectivity in compressed sparse rows, one row per independent wire
+		std::vector<size_t> _gcCheckOffsets;	// size: independent wires + 1
+		std::vector<uint32_t> _gcCheckAndOrders;
+		std::vector<uint8_t> _gcCheckConnections;
+
+		// Level schedule: gate indices grouped by level, linear gates before AND gates
+		std::vector<size_t> _levelGates;
+		std::vector<size_t> _levelBegin;	// size: levels + 1
+		std::vector<size_t> _levelAndBegin;	// size: levels
 
-		// size: independent wires
-		// bitset: [0] for i , [1] for j, set representing the wire is connected
-		std::vector<std::unordered_map<size_t /*gate index*/, std::bitset<2> /*connected*/>> _gcCheckData;
+		// Label storage slot of every wire, recycled along the level schedule
+		std::vector<uint32_t> _labelSlot;
+		size_t _labelSlotSize {};
 
 		void _init_gc_check_data ();
 
+		void _init_level_schedule();
+
+		void _init_label_slots();
+
+		Circuit() = default;
+
 		static void Populate_XOR_source_matrix_(
 			const std::vector<Gate>& gates,
 			XORSourceMatrix& xorSourceMatrix,
@@ -213,6 +293,7 @@ namespace ATLab {
 
 	public:
 		static constexpr size_t AND_ORDER_DISABLED {std::numeric_limits<size_t>::max()};
+		static constexpr uint32_t NO_SOURCE_GATE {std::numeric_limits<uint32_t>::max()};
 
 		size_t
 			gateSize {},
@@ -224,9 +305,29 @@ namespace ATLab {
 			andGateSize {};
 
 		std::vector<Gate> gates;
+		GateArrays gateArrays;
 
+		// Parses a circuit in Bristol format
 		explicit Circuit(const std::string& filename);
 
+		// Version of the binary format written by `save`
+		static constexpr uint32_t BINARY_FORMAT_VERSION {1};
+
+		/**
+		 * Writes the circuit together with all derived indexes (AND order, XOR sources, GC-check rows,
+		 * level schedule, label slots) in the binary format read by `Load`.
+		 * The format is native-endian; it is only meant to be loaded on the same architecture.
+		 */
+		void save(const std::string& filename) const;
+
+		/**
+		 * Loads a circuit written by `save`. The file is mapped read-only and its arrays are copied out,
+		 * without parsing or rebuilding any index.
+		 * Throws std::runtime_error on a malformed or truncated file, or a different format version.
+		 */
+		[[nodiscard]]
+		static Circuit Load(const std::string& filename);
+
 		[[nodiscard]]
 		size_t and_gate_order(size_t gateIndex) const;
 
@@ -243,16 +344,16 @@ namespace ATLab {
 
 		[[nodiscard]]
 		size_t gate_index_by_output_wire(const Wire outputWire) const {
-			const auto it {_outputWireToGateIndex.find(outputWire)};
 #ifdef DEBUG
-			if (it == _outputWireToGateIndex.cend()) {
+			if (outputWire < 0 || outputWire >= static_cast<Wire>(wireSize)
+				|| _outputWireToGateIndex[outputWire] == NO_SOURCE_GATE) {
 				std::ostringstream sout;
 				sout << "Output wire " << outputWire << " not found.\n";
 				throw std::out_of_range{sout.str()};
 			}
 #endif // DEBUG
-			assert(it != _outputWireToGateIndex.cend());
-			return it->second;
+			assert(_outputWireToGateIndex[outputWire] != NO_SOURCE_GATE);
+			return _outputWireToGateIndex[outputWire];
 		}
 
 		[[nodiscard]]
@@ -278,9 +379,14 @@ namespace ATLab {
 		 * @param w wire index, NOT independent wire index
 		 */
 		[[nodiscard]]
-		auto& gc_check_data(const Wire w) const {
+		GCCheckRow gc_check_data(const Wire w) const noexcept {
 			const size_t independentIndex {independent_index_map(w)};
-			return _gcCheckData[independentIndex];
+			const size_t begin {_gcCheckOffsets[independentIndex]};
+			const size_t size {_gcCheckOffsets[independentIndex + 1] - begin};
+			return {
+				boost::span<const uint32_t>{_gcCheckAndOrders.data() + begin, size},
+				boost::span<const uint8_t>{_gcCheckConnections.data() + begin, size}
+			};
 		}
 
 		[[nodiscard]]
@@ -288,6 +394,17 @@ namespace ATLab {
 			return andGateSize + totalInputSize;
 		}
 
+		[[nodiscard]]
+		size_t and_gate_index(const size_t andGateOrder) const noexcept {
+			assert(andGateOrder < andGateSize);
+			return _andToGlobalIndex[andGateOrder];
+		}
+
+		[[nodiscard]]
+		const Gate& and_gate(const size_t andGateOrder) const noexcept {
+			return gates[and_gate_index(andGateOrder)];
+		}
+
 		template <typename Callback>
 		void for_each_AND_gate(Callback&& callback) const {
 			for (size_t i {0}; i != _andToGlobalIndex.size(); ++i) {
@@ -297,6 +414,57 @@ namespace ATLab {
 			}
 		}
 
+		/**
+		 * Number of levels of the schedule. Level l holds the AND gates whose inputs have AND-depth at most l,
+		 * and the linear gates whose outputs have AND-depth l.
+		 */
+		[[nodiscard]]
+		size_t level_size() const noexcept {
+			return _levelAndBegin.size();
+		}
+
+		[[nodiscard]]
+		CircuitLevel level(const size_t l) const noexcept {
+			assert(l < level_size());
+			const size_t* base {_levelGates.data()};
+			return {
+				boost::span<const size_t>{base + _levelBegin[l], _levelAndBegin[l] - _levelBegin[l]},
+				boost::span<const size_t>{base + _levelAndBegin[l], _levelBegin[l + 1] - _levelAndBegin[l]}
+			};
+		}
+
+		/**
+		 * Calls `callback(gate, scheduleIndex)` for every AND gate in schedule order,
+		 * where `scheduleIndex` counts the AND gates in that order. Garbled tables are transferred in this order.
+		 */
+		template <typename Callback>
+		void for_each_scheduled_AND_gate(Callback&& callback) const {
+			size_t scheduleIndex {0};
+			for (size_t l {0}; l != level_size(); ++l) {
+				for (const size_t gateIndex : level(l).andGates) {
+					callback(gates[gateIndex], scheduleIndex);
+					++scheduleIndex;
+				}
+			}
+		}
+
+		/**
+		 * Index of the label of wire `w` in the label vectors of garbling and evaluation.
+		 * Slots of linear wires are reused once their last reader in the level schedule is processed.
+		 * Input wires keep slots [0, totalInputSize); independent and output wires are never recycled.
+		 */
+		[[nodiscard]]
+		uint32_t label_slot(const Wire w) const noexcept {
+			assert(w >= 0 && w < static_cast<Wire>(wireSize));
+			return _labelSlot[w];
+		}
+
+		// Size of the label vectors, at most wireSize
+		[[nodiscard]]
+		size_t label_slot_size() const noexcept {
+			return _labelSlotSize;
+		}
+
 		[[nodiscard]]
 		bool is_independent(const Wire w) const noexcept {
 			assert(w >= 0 && w < static_cast<Wire>(wireSize));
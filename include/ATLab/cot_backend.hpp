@@ -0,0 +1,100 @@
+#ifndef ATLab_COT_BACKEND_HPP
+#define ATLab_COT_BACKEND_HPP
+
+#include <memory>
+#include <vector>
+
+#include <emp-tool/utils/block.h>
+#include <emp-ot-original/iknp.h>
+
+#include "net-io.hpp"
+#include "PRNG.hpp"
+
+namespace ATLab::BlockCorrelatedOT {
+
+    using OT = emp::IKNP<NetIO>;
+
+    /**
+     * Source of random correlated OTs under a backend-chosen Δ.
+     * The sender obtains keys K, and the receiver obtains random bits b with macs K ^ b Δ.
+     * Both parties must request the same lengths in the same order.
+     */
+    class COTSenderBackend {
+    public:
+        virtual ~COTSenderBackend() = default;
+
+        // The IKNP instance the backend was built on, also used for plain 1-out-of-2 OTs
+        virtual OT& simple_ot() noexcept = 0;
+
+        [[nodiscard]]
+        virtual emp::block delta() const noexcept = 0;
+
+        virtual void send_cot(emp::block* keys, size_t len) = 0;
+    };
+
+    class COTReceiverBackend {
+    public:
+        virtual ~COTReceiverBackend() = default;
+
+        virtual OT& simple_ot() noexcept = 0;
+
+        /**
+         * @param choices receives `len` random choice bits
+         */
+        virtual void recv_cot(emp::block* macs, bool* choices, size_t len) = 0;
+    };
+
+    // Fallback backend: every COT is one IKNP extension
+    class IKNPSender final : public COTSenderBackend {
+        std::unique_ptr<OT> _ot;
+    public:
+        explicit IKNPSender(NetIO& io):
+            _ot {std::make_unique<OT>(&io, true)}
+        {
+            _ot->setup_send();
+        }
+
+        OT& simple_ot() noexcept override {
+            return *_ot;
+        }
+
+        [[nodiscard]]
+        emp::block delta() const noexcept override {
+            return _ot->Delta;
+        }
+
+        void send_cot(emp::block* keys, const size_t len) override {
+            _ot->send_cot(keys, static_cast<int64_t>(len));
+        }
+    };
+
+    class IKNPReceiver final : public COTReceiverBackend {
+        std::unique_ptr<OT> _ot;
+    public:
+        explicit IKNPReceiver(NetIO& io):
+            _ot {std::make_unique<OT>(&io, true)}
+        {
+            _ot->setup_recv();
+        }
+
+        OT& simple_ot() noexcept override {
+            return *_ot;
+        }
+
+        void recv_cot(emp::block* macs, bool* choices, const size_t len) override {
+            for (size_t i {0}; i != len; ++i) {
+                choices[i] = THE_GLOBAL_PRNG() & 1;
+            }
+            _ot->recv_cot(macs, choices, static_cast<int64_t>(len));
+        }
+    };
+
+    /**
+     * Backend used by BlockCorrelatedOT::Sender/Receiver.
+     * IKNP by default; the silent Ferret backend if `BCOT_BACKEND_FERRET` is defined.
+     */
+    std::unique_ptr<COTSenderBackend> make_COT_sender_backend(NetIO& io);
+    std::unique_ptr<COTReceiverBackend> make_COT_receiver_backend(NetIO& io);
+}
+
+#endif // ATLab_COT_BACKEND_HPP
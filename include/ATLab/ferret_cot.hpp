@@ -0,0 +1,102 @@
+#ifndef ATLab_FERRET_COT_HPP
+#define ATLab_FERRET_COT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "cot_backend.hpp"
+
+/**
+ * Silent correlated OT in the style of Ferret (Yang-Weng-Lan-Zhang-Wang, CCS'20).
+ * Each round turns `reserve_size()` base COTs into `n` COTs:
+ *   - MPFSS with regular noise: one GGM tree of 2^treeHeight leaves per noisy position,
+ *     whose sibling sums are transferred with `treeHeight` base COTs each;
+ *   - primal LPN with a fixed public sparse matrix of 10 uniform ones per row.
+ * The last `reserve_size()` outputs are kept as the base of the next round; the first round is
+ * bootstrapped from IKNP. Communication per round is O(t · treeHeight) blocks instead of O(n).
+ *
+ * The MPFSS is followed by Ferret's consistency check, which spends CHECK_SIZE more base COTs: the
+ * receiver sends a seed for random weights χ_i ∈ GF(2^128) and Σ χ_α ⊕ x*, where α are its noisy
+ * positions and x* packs the choice bits of the extra COTs; the sender answers with a hash of
+ * Σ χ_i v_i ⊕ Y ⊕ (Σ χ_α ⊕ x*)·Δ, which the receiver recomputes from its side. Inconsistent GGM sums
+ * from a malicious sender fail the check except for a selective failure on the noisy positions,
+ * which the LPN parameters of the paper account for. The backend is opt-in; IKNP remains the default.
+ */
+namespace ATLab::BlockCorrelatedOT {
+
+    struct FerretParam {
+        size_t n;           // outputs per round, must equal t * 2^treeHeight
+        size_t k;           // LPN secret length
+        size_t t;           // noise weight, number of GGM trees
+        size_t treeHeight;
+
+        // Base COTs of the consistency check, packed into one GF(2^128) element
+        static constexpr size_t CHECK_SIZE {128};
+
+        [[nodiscard]]
+        size_t reserve_size() const noexcept {
+            return k + t * treeHeight + CHECK_SIZE;
+        }
+
+        [[nodiscard]]
+        size_t usable_size() const noexcept {
+            return n - reserve_size();
+        }
+
+        void check() const;
+
+        // Regular-noise parameters for 128-bit security from the Ferret paper
+        static FerretParam Default() noexcept {
+            return {10'805'248, 589'760, 1'319, 13};
+        }
+    };
+
+    class FerretSender final : public COTSenderBackend {
+        const FerretParam _param;
+        IKNPSender _base;
+        NetIO& _io;
+        uint64_t _round {0};
+        std::vector<emp::block> _keys;
+        size_t _cursor {0};
+
+        void _extend();
+
+    public:
+        explicit FerretSender(NetIO& io, FerretParam param = FerretParam::Default());
+
+        OT& simple_ot() noexcept override {
+            return _base.simple_ot();
+        }
+
+        [[nodiscard]]
+        emp::block delta() const noexcept override {
+            return _base.delta();
+        }
+
+        void send_cot(emp::block* keys, size_t len) override;
+    };
+
+    class FerretReceiver final : public COTReceiverBackend {
+        const FerretParam _param;
+        IKNPReceiver _base;
+        NetIO& _io;
+        uint64_t _round {0};
+        std::vector<emp::block> _macs;
+        Bitset _choices;
+        size_t _cursor {0};
+
+        void _extend();
+
+    public:
+        explicit FerretReceiver(NetIO& io, FerretParam param = FerretParam::Default());
+
+        OT& simple_ot() noexcept override {
+            return _base.simple_ot();
+        }
+
+        void recv_cot(emp::block* macs, bool* choices, size_t len) override;
+    };
+}
+
+#endif // ATLab_FERRET_COT_HPP
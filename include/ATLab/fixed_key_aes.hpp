@@ -0,0 +1,106 @@
+#ifndef ATLab_FIXED_KEY_AES_HPP
+#define ATLab_FIXED_KEY_AES_HPP
+
+#include <array>
+#include <cstddef>
+
+#include <wmmintrin.h>
+#include <emp-tool/utils/block.h>
+
+namespace ATLab {
+    // AES-128 with a key expanded once. Used as a public random permutation π.
+    class FixedKeyAES {
+        static constexpr size_t ROUNDS {10};
+        std::array<emp::block, ROUNDS + 1> _roundKeys;
+
+        static emp::block Expand_round_key_(emp::block key, emp::block assisted) noexcept {
+            assisted = _mm_shuffle_epi32(assisted, _MM_SHUFFLE(3, 3, 3, 3));
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            return _mm_xor_si128(key, assisted);
+        }
+
+    public:
+        explicit FixedKeyAES(const emp::block& key) noexcept {
+            // `_mm_aeskeygenassist_si128` requires the round constant to be an immediate
+            auto& rk {_roundKeys};
+            rk[0]  = key;
+            rk[1]  = Expand_round_key_(rk[0], _mm_aeskeygenassist_si128(rk[0], 0x01));
+            rk[2]  = Expand_round_key_(rk[1], _mm_aeskeygenassist_si128(rk[1], 0x02));
+            rk[3]  = Expand_round_key_(rk[2], _mm_aeskeygenassist_si128(rk[2], 0x04));
+            rk[4]  = Expand_round_key_(rk[3], _mm_aeskeygenassist_si128(rk[3], 0x08));
+            rk[5]  = Expand_round_key_(rk[4], _mm_aeskeygenassist_si128(rk[4], 0x10));
+            rk[6]  = Expand_round_key_(rk[5], _mm_aeskeygenassist_si128(rk[5], 0x20));
+            rk[7]  = Expand_round_key_(rk[6], _mm_aeskeygenassist_si128(rk[6], 0x40));
+            rk[8]  = Expand_round_key_(rk[7], _mm_aeskeygenassist_si128(rk[7], 0x80));
+            rk[9]  = Expand_round_key_(rk[8], _mm_aeskeygenassist_si128(rk[8], 0x1b));
+            rk[10] = Expand_round_key_(rk[9], _mm_aeskeygenassist_si128(rk[9], 0x36));
+        }
+
+        [[nodiscard]]
+        emp::block encrypt(emp::block block) const noexcept {
+            block = _mm_xor_si128(block, _roundKeys[0]);
+            for (size_t round {1}; round != ROUNDS; ++round) {
+                block = _mm_aesenc_si128(block, _roundKeys[round]);
+            }
+            return _mm_aesenclast_si128(block, _roundKeys[ROUNDS]);
+        }
+
+        /**
+         * π applied in place to `n` independent blocks, interleaved to keep the AES pipeline full.
+         * Uses VAES on AVX-512 when the CPU supports it, detected at runtime, and 8-wide AES-NI otherwise.
+         */
+        void encrypt_batch(emp::block* blocks, size_t n) const noexcept;
+
+        // The same public permutation is shared by both parties and never re-keyed.
+        static const FixedKeyAES& Get_instance() noexcept {
+            // Hexadecimal digits of π, nothing up the sleeve
+            static const FixedKeyAES instance {_mm_set_epi64x(0x243F6A8885A308D3LL, 0x13198A2E03707344LL)};
+            return instance;
+        }
+    };
+
+    /**
+     * Linear orthomorphism σ(x_L || x_R) = (x_L ⊕ x_R) || x_L
+     */
+    inline emp::block sigma(const emp::block& x) noexcept {
+        const emp::block swapped {_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2))};
+        const emp::block highOnly {_mm_unpackhi_epi64(_mm_setzero_si128(), x)};
+        return _mm_xor_si128(swapped, highOnly);
+    }
+
+    /**
+     * Tweakable circular correlation robust hash from a fixed-key permutation:
+     * TMMO^σ_π(x, i) = π(π(x) ⊕ i) ⊕ σ(π(x))  (Guo-Katz-Wang-Yu, S&P'20)
+     */
+    inline emp::block tccr_hash(const emp::block& x, const emp::block& tweak) noexcept {
+        const FixedKeyAES& pi {FixedKeyAES::Get_instance()};
+        const emp::block u {pi.encrypt(x)};
+        return _mm_xor_si128(pi.encrypt(_mm_xor_si128(u, tweak)), sigma(u));
+    }
+
+    constexpr size_t TCCR_HASH_BATCH_SIZE {32};
+
+    // out[i] = tccr_hash(x[i], tweaks[i]) for n independent inputs, hashed TCCR_HASH_BATCH_SIZE at a time
+    void tccr_hash_batch(const emp::block* x, const emp::block* tweaks, emp::block* out, size_t n) noexcept;
+
+    // tccr_hash(x, ·) with π(x) computed once, for hashing one block under many tweaks
+    class TCCRHasher {
+        const FixedKeyAES& _pi;
+        const emp::block _u, _sigmaU;
+    public:
+        explicit TCCRHasher(const emp::block& x) noexcept:
+            _pi {FixedKeyAES::Get_instance()},
+            _u {_pi.encrypt(x)},
+            _sigmaU {sigma(_u)}
+        {}
+
+        [[nodiscard]]
+        emp::block operator()(const emp::block& tweak) const noexcept {
+            return _mm_xor_si128(_pi.encrypt(_mm_xor_si128(_u, tweak)), _sigmaU);
+        }
+    };
+}
+
+#endif // ATLab_FIXED_KEY_AES_HPP
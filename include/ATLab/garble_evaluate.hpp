@@ -1,37 +1,121 @@
 #ifndef ATLab_GARBLE_HPP
 #define ATLab_GARBLE_HPP
 
+#include <array>
+#include <cstddef>
 #include <vector>
 
+#include <emp-tool/utils/hash.h>
+
 #include "circuit_parser.hpp"
+#include "fixed_key_aes.hpp"
 #include "global_key_sampling.hpp"
 #include "preprocess.hpp"
 
 namespace ATLab {
-    inline emp::block hash(const emp::block& block, const Wire w, const int pad) {
-        const std::array<emp::block, 2> blocks {block, _mm_set_epi64x(w, pad)};
+    inline emp::block garble_tweak(const Wire w, const int pad) noexcept {
+        return _mm_set_epi64x(w, pad);
+    }
+
+    /**
+     * The garbling hash H(label, (w, pad)), with the tweak from `garble_tweak`.
+     * Fixed-key AES TCCR hash by default. Define `GARBLE_HASH_SHA256` to fall back to SHA-256.
+     * Both parties must be built with the same choice.
+     */
+    inline emp::block hash_tweaked(const emp::block& block, const emp::block& tweak) {
+#ifdef GARBLE_HASH_SHA256
+        const std::array<emp::block, 2> blocks {block, tweak};
         return emp::Hash::hash_for_block(blocks.data(), blocks.size() * sizeof(emp::block));
+#else
+        return tccr_hash(block, tweak);
+#endif // GARBLE_HASH_SHA256
+    }
+
+    inline emp::block hash(const emp::block& block, const Wire w, const int pad) {
+        return hash_tweaked(block, garble_tweak(w, pad));
+    }
+
+    // out[i] = hash_tweaked(blocks[i], tweaks[i]), with the AES calls of independent inputs interleaved
+    inline void hash_batch(const emp::block* blocks, const emp::block* tweaks, emp::block* out, const size_t n) {
+#ifdef GARBLE_HASH_SHA256
+        for (size_t i {0}; i != n; ++i) {
+            out[i] = hash_tweaked(blocks[i], tweaks[i]);
+        }
+#else
+        tccr_hash_batch(blocks, tweaks, out, n);
+#endif // GARBLE_HASH_SHA256
     }
 
+    // AND gates whose hashes are computed together by one `hash_batch` call
+    constexpr size_t GARBLE_BATCH_SIZE {8};
+
     using GarbledTableVec = std::vector<std::array<emp::block, 2>>;
 
+    /**
+     * Number of AND gates per garbled-table chunk on the wire.
+     * A chunk holds the tables of GARBLE_CHUNK_SIZE gates followed by their wireMaskShift bits as
+     * BitsetBlocks; the last chunk may be shorter. A multiple of the BitsetBlock width, so the
+     * concatenated shift words form the whole wireMaskShift.
+     */
+    constexpr size_t GARBLE_CHUNK_SIZE {1 << 14};
+    static_assert(GARBLE_CHUNK_SIZE % Bitset::bits_per_block == 0);
+    // Chunks buffered by the pipelined evaluator, bounding its table memory to GARBLE_RECV_WINDOW chunks
+    constexpr size_t GARBLE_RECV_WINDOW {4};
+
+    // SHA-256 of the garbled-table chunks as sent, binding the garbler to its tables before the input phase
+    using GarbledTablesDigest = std::array<std::byte, emp::Hash::DIGEST_SIZE>;
+
     namespace Garbler {
+        /**
+         * Garbled tables are streamed to the evaluator during garbling and not kept.
+         * Every wire satisfies label1 = label0 ⊕ Δ: a NOT gate sets its label0 to label1 of its input, which
+         * swaps the pair without breaking the relation. Only label0 is stored, indexed by Circuit::label_slot,
+         * so only the labels of input, independent and output wires are still valid after garbling.
+         */
         struct GarbledCircuit {
-            std::vector<emp::block> label0, label1;
-            GarbledTableVec garbledTables;
-            Bitset wireMaskShift;
+            std::vector<emp::block> label0;
+            emp::block globalKey;
+
+            [[nodiscard]]
+            emp::block label1(const uint32_t slot) const noexcept {
+                return _mm_xor_si128(label0[slot], globalKey);
+            }
         };
 
+        /**
+         * Garbles the circuit level by level (see Circuit::level), streaming the tables in schedule order.
+         * @param threadCount threads garbling the AND gates of a level, 0 meaning one per hardware thread.
+         *                    The output does not depend on it.
+         */
         GarbledCircuit garble(
             ATLab::NetIO& io,
             const Circuit& circuit,
             const PreprocessedData& wireMasks,
-            std::vector<emp::block> label0 = {}
+            std::vector<emp::block> label0 = {},
+            size_t threadCount = 1
+        );
+
+        /**
+         * Garbles without sending and sends the digest of the tables that `garble` will stream with the same
+         * arguments; garbling is deterministic once label0 of the inputs is fixed.
+         * Pairs with Evaluator::recv_garbled_tables_commitment.
+         * @param label0 those of the input wires, as later passed to `garble`
+         */
+        void commit_garbled_tables(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const PreprocessedData& wireMasks,
+            std::vector<emp::block> label0,
+            size_t threadCount = 1
         );
+
+        // Random label0 of the input wires, to be passed to `garble` later
+        GarbledCircuit gen_input_labels(const Circuit& circuit, const PreprocessedData& wireMasks);
     }
 
     namespace Evaluator {
 
+        // Indexed in AND-gate schedule order (Circuit::for_each_scheduled_AND_gate)
         struct ReceivedGarbledCircuit {
             GarbledTableVec garbledTables;
             Bitset wireMaskShift;
@@ -39,17 +123,53 @@ namespace ATLab {
 
         ReceivedGarbledCircuit garble(ATLab::NetIO& io, const Circuit& circuit);
 
+        // maskedValues are indexed by wire, labels by Circuit::label_slot
         struct EvaluateResult {
             Bitset maskedValues;
             std::vector<emp::block> labels;
         };
 
+        // @param threadCount as in Garbler::garble
         EvaluateResult evaluate(
             const Circuit&                  circuit,
             const PreprocessedData&         wireMasks,
             const ReceivedGarbledCircuit&   garbledCircuit,
             std::vector<emp::block>         labels,
-            Bitset                          maskedValues
+            Bitset                          maskedValues,
+            size_t                          threadCount = 1
+        );
+
+        /**
+         * Pipelined `garble` + `evaluate`: gates are evaluated while later chunks are still in flight.
+         * A background thread receives the chunks into a window of GARBLE_RECV_WINDOW chunks, so
+         * `io` must not be used elsewhere until this returns. If evaluation throws before every chunk
+         * arrived, `io` is shut down (see NetIO::shutdown) so that the receiving thread can be joined.
+         * @param labels,maskedValues those of the input wires
+         * @param threadCount as in Garbler::garble
+         */
+        EvaluateResult garble_and_evaluate(
+            ATLab::NetIO&                   io,
+            const Circuit&                  circuit,
+            const PreprocessedData&         wireMasks,
+            std::vector<emp::block>         labels,
+            Bitset                          maskedValues,
+            size_t                          threadCount = 1
+        );
+
+        GarbledTablesDigest recv_garbled_tables_commitment(ATLab::NetIO& io);
+
+        /**
+         * `garble_and_evaluate` that also hashes the received chunks and throws if they do not match
+         * `commitment`, from `recv_garbled_tables_commitment`.
+         */
+        EvaluateResult garble_and_evaluate(
+            ATLab::NetIO&                   io,
+            const Circuit&                  circuit,
+            const PreprocessedData&         wireMasks,
+            std::vector<emp::block>         labels,
+            Bitset                          maskedValues,
+            const GarbledTablesDigest&      commitment,
+            size_t                          threadCount = 1
         );
     }
 }
@@ -1,6 +1,7 @@
 #ifndef ATLAB_NET_IO_HPP
 #define ATLAB_NET_IO_HPP
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cerrno>
@@ -13,6 +14,7 @@
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <vector>
 #include <immintrin.h>
 
 #include <arpa/inet.h>
@@ -20,6 +22,7 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <emp-tool/utils/block.h>
@@ -30,6 +33,78 @@ namespace ATLab {
 
     constexpr int NETWORK_BUFFER_SIZE2 {1024 * 32};
     constexpr int NETWORK_BUFFER_SIZE {1024 * 1024};
+    constexpr size_t NETWORK_BUFFER_ALIGNMENT {64};
+
+    /**
+     * Cache-line aligned byte buffer holding the live range [begin, end).
+     * Consumed space is reclaimed when the buffer drains, or by moving the live range to the front.
+     */
+    class SocketBuffer {
+        struct Deleter {
+            void operator()(char* p) const noexcept {
+                std::free(p);
+            }
+        };
+        std::unique_ptr<char[], Deleter> _data;
+        size_t _begin {0}, _end {0};
+    public:
+        const size_t capacity;
+
+        explicit SocketBuffer(const size_t capacityIn):
+            _data {static_cast<char*>(std::aligned_alloc(NETWORK_BUFFER_ALIGNMENT, capacityIn))},
+            capacity {capacityIn}
+        {
+            if (!_data) {
+                throw std::bad_alloc{};
+            }
+        }
+
+        [[nodiscard]]
+        size_t size() const noexcept {
+            return _end - _begin;
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept {
+            return _begin == _end;
+        }
+
+        [[nodiscard]]
+        size_t free_tail() const noexcept {
+            return capacity - _end;
+        }
+
+        [[nodiscard]]
+        const char* data() const noexcept {
+            return _data.get() + _begin;
+        }
+
+        [[nodiscard]]
+        char* tail() noexcept {
+            return _data.get() + _end;
+        }
+
+        void commit(const size_t n) noexcept {
+            assert(n <= free_tail());
+            _end += n;
+        }
+
+        void consume(const size_t n) noexcept {
+            assert(n <= size());
+            _begin += n;
+            if (_begin == _end) {
+                _begin = _end = 0;
+            }
+        }
+
+        void compact() noexcept {
+            if (_begin) {
+                std::memmove(_data.get(), data(), size());
+                _end -= _begin;
+                _begin = 0;
+            }
+        }
+    };
 
     template<typename T>
     class IOChannel {
@@ -113,69 +188,78 @@ namespace ATLab {
             }
         }
 
+        /**
+         * Packs every 8 bools into one byte (the first bool in the LSB) followed by the remaining bools
+         * one per byte, and sends the whole scratch buffer at once.
+         */
         void send_bool_aligned(const bool* data, size_t length) {
-            const bool* data64 {data};
+            const size_t packedSize {length / 8}, tailSize {length % 8};
+            std::vector<uint8_t> scratch(packedSize + tailSize);
+            Pack_bools_(data, packedSize, scratch.data());
+            std::memcpy(scratch.data() + packedSize, data + 8 * packedSize, tailSize);
+            send_data(scratch.data(), scratch.size());
+        }
+
+        void recv_bool_aligned(bool* data, size_t length) {
+            const size_t packedSize {length / 8}, tailSize {length % 8};
+            std::vector<uint8_t> scratch(packedSize + tailSize);
+            recv_data(scratch.data(), scratch.size());
+            Unpack_bools_(scratch.data(), packedSize, data);
+            std::memcpy(data + 8 * packedSize, scratch.data() + packedSize, tailSize);
+        }
+
+    private:
+        T& derived() {
+            return *static_cast<T*>(this);
+        }
+
+        const T& derived() const {
+            return *static_cast<const T*>(this);
+        }
+
+        // `data` holds 8 * byteSize bools
+        static void Pack_bools_(const bool* data, const size_t byteSize, uint8_t* out) noexcept {
             size_t i {0};
-            unsigned long long unpack {0};
-            for (; i < length / 8; ++i) {
-                unsigned long long mask {0x0101010101010101ULL};
-                unsigned long long tmp {0};
-                std::memcpy(&unpack, data64, sizeof(unpack));
-                data64 += sizeof(unpack);
+#if defined(__AVX2__)
+            // 32 bools per movemask; bools are 0 or 1, so move the bit up to each byte's MSB
+            for (; i + 4 <= byteSize; i += 4) {
+                const __m256i v {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 8 * i))};
+                const auto bits {static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi16(v, 7)))};
+                std::memcpy(out + i, &bits, sizeof(bits));
+            }
+#endif
+            for (; i < byteSize; ++i) {
+                uint64_t unpack;
+                std::memcpy(&unpack, data + 8 * i, sizeof(unpack));
 #if defined(__BMI2__)
-                tmp = _pext_u64(unpack, mask);
+                out[i] = static_cast<uint8_t>(_pext_u64(unpack, 0x0101010101010101ULL));
 #else
-                for (unsigned long long bitMask = 1; mask != 0; bitMask += bitMask) {
-                    if (unpack & mask & -mask) {
-                        tmp |= bitMask;
-                    }
-                    mask &= (mask - 1);
+                uint8_t tmp {0};
+                for (size_t bit {0}; bit != 8; ++bit) {
+                    tmp |= static_cast<uint8_t>(((unpack >> (8 * bit)) & 1) << bit);
                 }
+                out[i] = tmp;
 #endif
-                send_data(&tmp, 1);
-            }
-            if (8 * i != length) {
-                send_data(data + 8 * i, length - 8 * i);
             }
         }
 
-        void recv_bool_aligned(bool* data, size_t length) {
-            bool* data64 {data};
-            size_t i {0};
-            unsigned long long unpack {0};
-            for (; i < length / 8; ++i) {
-                unsigned long long mask {0x0101010101010101ULL};
-                unsigned long long tmp {0};
-                recv_data(&tmp, 1);
+        static void Unpack_bools_(const uint8_t* packed, const size_t byteSize, bool* data) noexcept {
+            for (size_t i {0}; i < byteSize; ++i) {
 #if defined(__BMI2__)
-                unpack = _pdep_u64(tmp, mask);
+                const uint64_t unpack {_pdep_u64(packed[i], 0x0101010101010101ULL)};
 #else
-                unpack = 0;
-                for (unsigned long long bitMask = 1; mask != 0; bitMask += bitMask) {
-                    if (tmp & bitMask) {
-                        unpack |= mask & (-mask);
-                    }
-                    mask &= (mask - 1);
+                uint64_t unpack {0};
+                for (size_t bit {0}; bit != 8; ++bit) {
+                    unpack |= static_cast<uint64_t>((packed[i] >> bit) & 1) << (8 * bit);
                 }
 #endif
-                std::memcpy(data64, &unpack, sizeof(unpack));
-                data64 += sizeof(unpack);
+                std::memcpy(data + 8 * i, &unpack, sizeof(unpack));
             }
-            if (8 * i != length) {
-                recv_data(data + 8 * i, length - 8 * i);
-            }
-        }
-
-    private:
-        T& derived() {
-            return *static_cast<T*>(this);
-        }
-
-        const T& derived() const {
-            return *static_cast<const T*>(this);
         }
     };
 
+    class Session;
+
     class NetIO : public IOChannel<NetIO> {
     public:
         enum Role {
@@ -197,29 +281,14 @@ namespace ATLab {
             }
 
             if (role == Role::SERVER) {
+                mysocket = Listen_(address, port, 1);
                 sockaddr_in dest {};
-                sockaddr_in serv {};
                 socklen_t sockSize {sizeof(sockaddr_in)};
-                serv.sin_family = AF_INET;
-                serv.sin_addr.s_addr = inet_addr(address.c_str());
-                serv.sin_port = htons(port);
-
-                mysocket = ::socket(AF_INET, SOCK_STREAM, 0);
-                if (mysocket < 0) {
-                    throw std::runtime_error {"Unable to create server socket"};
-                }
-
-                const int reuse {1};
-                setsockopt(mysocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
-                if (::bind(mysocket, reinterpret_cast<sockaddr*>(&serv), sizeof(sockaddr)) < 0) {
-                    throw std::runtime_error {std::string{"bind failed: "} + std::strerror(errno)};
-                }
-                if (::listen(mysocket, 1) < 0) {
-                    throw std::runtime_error {std::string{"listen failed: "} + std::strerror(errno)};
-                }
                 consocket = ::accept(mysocket, reinterpret_cast<sockaddr*>(&dest), &sockSize);
                 if (consocket < 0) {
-                    throw std::runtime_error {std::string{"accept failed: "} + std::strerror(errno)};
+                    const int acceptErrno {errno};
+                    ::close(mysocket);
+                    throw std::runtime_error {std::string{"accept failed: "} + std::strerror(acceptErrno)};
                 }
                 ::close(mysocket);
             } else {
@@ -245,41 +314,33 @@ namespace ATLab {
 
             set_nodelay();
 
-            sendStream = fdopen(consocket, "wb");
-            const int recvFd {dup(consocket)};
-            if (recvFd < 0 || sendStream == nullptr) {
-                throw std::runtime_error {"fdopen failed"};
-            }
-
-            recvStream = fdopen(recvFd, "rb");
-            if (recvStream == nullptr) {
-                throw std::runtime_error {"fdopen failed"};
-            }
-
-            sendBuffer = new char[NETWORK_BUFFER_SIZE];
-            std::memset(sendBuffer, 0, NETWORK_BUFFER_SIZE);
-            setvbuf(sendStream, sendBuffer, _IOFBF, NETWORK_BUFFER_SIZE);
-
-            recvBuffer = new char[NETWORK_BUFFER_SIZE];
-            std::memset(recvBuffer, 0, NETWORK_BUFFER_SIZE);
-            setvbuf(recvStream, recvBuffer, _IOFBF, NETWORK_BUFFER_SIZE);
             if (!quiet) {
                 std::cout << "connected\n";
             }
         }
 
+        NetIO(const NetIO&) = delete;
+        NetIO& operator=(const NetIO&) = delete;
+
         ~NetIO() {
-            flush();
-            if (sendStream != nullptr) {
-                fclose(sendStream);
+            // the session's OT backends may still talk to the peer
+            _session.reset();
+            try {
+                flush();
+            } catch (const std::exception&) {
+                // the peer is gone, nothing left to deliver
             }
-            if (recvStream != nullptr) {
-                fclose(recvStream);
+            if (consocket >= 0) {
+                ::close(consocket);
             }
-            delete[] sendBuffer;
-            delete[] recvBuffer;
         }
 
+        /**
+         * Protocol state of the session running over this connection (see session.hpp),
+         * created on first use and destroyed with the connection.
+         */
+        Session& session();
+
         [[nodiscard]]
         bool is_server() const {
             return role == Role::SERVER;
@@ -307,38 +368,87 @@ namespace ATLab {
             setsockopt(consocket, IPPROTO_TCP, TCP_NODELAY, &zero, sizeof(zero));
         }
 
+        // Unblocks a `recv_data` pending on another thread; the connection is unusable afterward
+        void shutdown() noexcept {
+            ::shutdown(consocket, SHUT_RDWR);
+        }
+
         void flush() {
-            if (sendStream != nullptr) {
-                fflush(sendStream);
+            while (!sendBuffer.empty()) {
+                sendBuffer.consume(Write_some_(consocket, sendBuffer.data(), sendBuffer.size()));
             }
         }
 
+        /**
+         * Small payloads are copied into the send buffer.
+         * A payload that does not fit is written together with the pending bytes by one `writev`,
+         * without being copied.
+         */
         void send_data_internal(const void* data, size_t len) {
-            size_t sent {0};
-            while (sent < len) {
-                const size_t res {fwrite(static_cast<const char*>(data) + sent, 1, len - sent, sendStream)};
-                if (res > 0) {
-                    sent += res;
-                } else {
-                    throw std::runtime_error {"net send data"};
-                }
+            const char* bytes {static_cast<const char*>(data)};
+            if (len <= sendBuffer.free_tail()) {
+                std::memcpy(sendBuffer.tail(), bytes, len);
+                sendBuffer.commit(len);
+                return;
+            }
+            if (len < sendBuffer.capacity) {
+                flush();
+                std::memcpy(sendBuffer.tail(), bytes, len);
+                sendBuffer.commit(len);
+                return;
+            }
+
+            while (!sendBuffer.empty()) {
+                std::array<iovec, 2> iov {{
+                    {const_cast<char*>(sendBuffer.data()), sendBuffer.size()},
+                    {const_cast<char*>(bytes), len}
+                }};
+                const size_t written {Writev_some_(consocket, iov.data(), static_cast<int>(iov.size()))};
+                const size_t fromBuffer {std::min(written, sendBuffer.size())};
+                sendBuffer.consume(fromBuffer);
+                bytes += written - fromBuffer;
+                len -= written - fromBuffer;
+            }
+            while (len) {
+                const size_t written {Write_some_(consocket, bytes, len)};
+                bytes += written;
+                len -= written;
             }
-            hasSent = true;
         }
 
+        /**
+         * Serves from the receive buffer first. A read larger than the buffer lands in the
+         * caller's memory directly; smaller reads refill the buffer with whatever is available.
+         */
         void recv_data_internal(void* data, size_t len) {
-            if (hasSent && sendStream != nullptr) {
-                fflush(sendStream);
+            flush();
+
+            char* bytes {static_cast<char*>(data)};
+            const size_t buffered {std::min(len, recvBuffer.size())};
+            std::memcpy(bytes, recvBuffer.data(), buffered);
+            recvBuffer.consume(buffered);
+            bytes += buffered;
+            len -= buffered;
+
+            if (len >= recvBuffer.capacity) {
+                while (len) {
+                    const size_t received {Read_some_(consocket, bytes, len)};
+                    bytes += received;
+                    len -= received;
+                }
+                return;
             }
-            hasSent = false;
-            size_t received {0};
-            while (received < len) {
-                const size_t res {fread(static_cast<char*>(data) + received, 1, len - received, recvStream)};
-                if (res > 0) {
-                    received += res;
-                } else {
-                    throw std::runtime_error {"net recv data"};
+
+            while (len) {
+                if (recvBuffer.free_tail() == 0) {
+                    recvBuffer.compact();
                 }
+                recvBuffer.commit(Read_some_(consocket, recvBuffer.tail(), recvBuffer.free_tail()));
+                const size_t n {std::min(len, recvBuffer.size())};
+                std::memcpy(bytes, recvBuffer.data(), n);
+                recvBuffer.consume(n);
+                bytes += n;
+                len -= n;
             }
         }
 
@@ -348,13 +458,163 @@ namespace ATLab {
         }
 
     private:
+        friend class NetIOListener;
+
+        // Server end of a connection accepted by NetIOListener
+        NetIO(const int acceptedSocket, const std::string& address, const int portIn, const bool quiet):
+            addr {address},
+            port {portIn},
+            role {Role::SERVER},
+            consocket {acceptedSocket}
+        {
+            set_nodelay();
+            if (!quiet) {
+                std::cout << "connected\n";
+            }
+        }
+
+        // Bound and listening server socket
+        static int Listen_(const std::string& address, const int port, const int backlog) {
+            sockaddr_in serv {};
+            serv.sin_family = AF_INET;
+            serv.sin_addr.s_addr = inet_addr(address.c_str());
+            serv.sin_port = htons(port);
+
+            const int sock {::socket(AF_INET, SOCK_STREAM, 0)};
+            if (sock < 0) {
+                throw std::runtime_error {"Unable to create server socket"};
+            }
+
+            const int reuse {1};
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+            if (::bind(sock, reinterpret_cast<sockaddr*>(&serv), sizeof(sockaddr)) < 0) {
+                const int bindErrno {errno};
+                ::close(sock);
+                throw std::runtime_error {std::string{"bind failed: "} + std::strerror(bindErrno)};
+            }
+            if (::listen(sock, backlog) < 0) {
+                const int listenErrno {errno};
+                ::close(sock);
+                throw std::runtime_error {std::string{"listen failed: "} + std::strerror(listenErrno)};
+            }
+            return sock;
+        }
+
         int mysocket {-1};
         int consocket {-1};
-        FILE* sendStream {nullptr};
-        FILE* recvStream {nullptr};
-        char* sendBuffer {nullptr};
-        char* recvBuffer {nullptr};
-        bool hasSent {false};
+        SocketBuffer sendBuffer {NETWORK_BUFFER_SIZE};
+        SocketBuffer recvBuffer {NETWORK_BUFFER_SIZE};
+        // shared_ptr deletes through the type-erased deleter, so Session may stay incomplete here
+        std::shared_ptr<Session> _session;
+
+        static size_t Write_some_(const int fd, const char* data, const size_t len) {
+            while (true) {
+                const ssize_t res {::send(fd, data, len, MSG_NOSIGNAL)};
+                if (res > 0) {
+                    return static_cast<size_t>(res);
+                }
+                if (res < 0 && errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error {"net send data"};
+            }
+        }
+
+        static size_t Writev_some_(const int fd, const iovec* iov, const int count) {
+            while (true) {
+                const ssize_t res {::writev(fd, iov, count)};
+                if (res > 0) {
+                    return static_cast<size_t>(res);
+                }
+                if (res < 0 && errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error {"net send data"};
+            }
+        }
+
+        static size_t Read_some_(const int fd, char* data, const size_t len) {
+            while (true) {
+                const ssize_t res {::recv(fd, data, len, 0)};
+                if (res > 0) {
+                    return static_cast<size_t>(res);
+                }
+                if (res < 0 && errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error {"net recv data"};
+            }
+        }
+    };
+
+    /**
+     * Server socket that stays open and hands out one NetIO per accepted connection,
+     * so a garbler can serve any number of evaluators without re-binding.
+     * `accept` may be called from several threads; `close` from any thread makes pending and later
+     * calls throw.
+     */
+    class NetIOListener {
+        int _socket;
+
+    public:
+        const std::string addr;
+        const int port; // the bound port, also when 0 was requested
+
+        /**
+         * @param portIn 0 to bind an ephemeral port
+         * @param backlog connections queued by the kernel while none is being accepted
+         */
+        NetIOListener(const std::string& address, const int portIn, const int backlog = SOMAXCONN):
+            _socket {NetIO::Listen_(address, Check_port_(portIn), backlog)},
+            addr {address},
+            port {Bound_port_(_socket)}
+        {}
+
+        NetIOListener(const NetIOListener&) = delete;
+        NetIOListener& operator=(const NetIOListener&) = delete;
+
+        ~NetIOListener() {
+            ::close(_socket);
+        }
+
+        // Blocks until a client connects
+        [[nodiscard]]
+        std::unique_ptr<NetIO> accept(const bool quiet = true) {
+            while (true) {
+                sockaddr_in dest {};
+                socklen_t sockSize {sizeof(sockaddr_in)};
+                const int sock {::accept(_socket, reinterpret_cast<sockaddr*>(&dest), &sockSize)};
+                if (sock >= 0) {
+                    return std::unique_ptr<NetIO>{new NetIO{sock, addr, port, quiet}};
+                }
+                const int acceptErrno {errno};
+                if (acceptErrno != EINTR && acceptErrno != ECONNABORTED) {
+                    throw std::runtime_error {std::string{"accept failed: "} + std::strerror(acceptErrno)};
+                }
+            }
+        }
+
+        // Stops accepting; blocked `accept` calls return with an exception
+        void close() noexcept {
+            ::shutdown(_socket, SHUT_RDWR);
+        }
+
+    private:
+        static int Check_port_(const int port) {
+            if (port < 0 || port > 65535) {
+                throw std::runtime_error {"Invalid port number"};
+            }
+            return port;
+        }
+
+        static int Bound_port_(const int sock) {
+            sockaddr_in bound {};
+            socklen_t sockSize {sizeof(sockaddr_in)};
+            if (::getsockname(sock, reinterpret_cast<sockaddr*>(&bound), &sockSize) < 0) {
+                throw std::runtime_error {std::string{"getsockname failed: "} + std::strerror(errno)};
+            }
+            return ntohs(bound.sin_port);
+        }
     };
 }
 
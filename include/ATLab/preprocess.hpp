@@ -1,6 +1,7 @@
 #ifndef ATLab_PREPROCESS_HPP
 #define ATLab_PREPROCESS_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -25,14 +26,42 @@ namespace ATLab {
         return static_cast<int>(res);
     }
 
-    // Calculate <a_i ^ b_j> when wires i and j are *independent* wires
+    // Calculate <a_i ^ b_j> when wires i and j are *independent* wires.
+    // Nothing is computed per pair up front: memory is the transposed macs/keys of a, linear in the
+    // circuit, and each sum is computed on demand by operator().
+    // Not thread-safe: operator() reuses the scratch buffers of the calculator.
     class DualKeyAuthed_ab_Calculator {
-        std::vector<emp::block> _resFlatMatrix; // (i, j) stores <b_i ^ a_j>'s LSB
-
         const Circuit& _circuit;
+        const Matrix<bool>& _matrix;
         const size_t _totalIndependent;
-    public:
+        const size_t _compressParam;
+
+        // Columns of aMatrix's macs (garbler) or keys (evaluator), global key major
+        std::vector<emp::block> _transposedRaw;
+        // Garbler only
+        Bitset _aBits;
+        std::vector<emp::block> _alphas;
+
+        // Scratch buffers of operator(), reset on every call
+        std::vector<Matrix<bool>::Block64> _rowSum;
+        std::vector<emp::block> _columnSum;
+
+        template <class ITMacs, class Getter>
+        void _transpose(const ITMacs& aMatrix, Getter&& get) {
+            const size_t&
+                transposedRow {_totalIndependent},
+                transposedCol {_compressParam};
+            _transposedRaw.reserve(transposedRow * transposedCol);
 
+            // The source is a flatted matrix, with `compressParam` rows, `totalIndependent` columns
+            for (size_t i = 0; i < transposedRow; ++i) {
+                for (size_t j = 0; j < transposedCol; ++j) {
+                    _transposedRaw.push_back(get(aMatrix, j, i));
+                }
+            }
+        }
+
+    public:
         DualKeyAuthed_ab_Calculator(DualKeyAuthed_ab_Calculator&&) = default;
 
         // For garbler
@@ -43,42 +72,22 @@ namespace ATLab {
             const ITMacBlockKeys& dualAuthedB
         ):
             _circuit {circuit},
-            _totalIndependent {circuit.totalInputSize + circuit.andGateSize}
+            _matrix {matrix},
+            _totalIndependent {circuit.totalInputSize + circuit.andGateSize},
+            _compressParam {matrix.colSize},
+            _aBits(_totalIndependent),
+            _rowSum(matrix.blocks_per_row()),
+            _columnSum(_compressParam)
         {
-            const size_t compressParam {matrix.colSize};
-
-            // Transpose aMatrix's macs to easily create a span of columns
-            const size_t&
-                transposedRow {_totalIndependent},
-                transposedCol {compressParam};
-            std::vector<emp::block> transposedRawMacs; // global key major
-            transposedRawMacs.reserve(transposedRow * transposedCol);
-
-            // Transpose rawMacs to _transposedRawMacs, ignoring the last row in rawMacs.
-            // rawMacs is a flatted matrix, with `compressParam` rows, `totalIndependent` columns
-            for (size_t i = 0; i < transposedRow; ++i) {
-                for (size_t j = 0; j < transposedCol; ++j) {
-                    transposedRawMacs.push_back(aMatrix.get_mac(j, i));
-                }
+            _transpose(aMatrix, [](const ITMacBits& macs, const size_t j, const size_t i) {
+                return macs.get_mac(j, i);
+            });
+            for (size_t col {0}; col != _totalIndependent; ++col) {
+                _aBits.set(col, aMatrix[col]);
             }
-
-            const size_t& resMatrixRow {matrix.rowSize}, resMatrixCol {_totalIndependent};
-            _resFlatMatrix.reserve(resMatrixRow * resMatrixCol);
-
-            // <b_i a_j>
-            for (size_t row {0}; row != resMatrixRow; ++row) {
-                const auto compressMatrixRow {matrix.row(row)};
-                const emp::block alpha {dualAuthedB.get_local_key(0, row)};
-                for (size_t col {0}; col != resMatrixCol; ++col) {
-                    const boost::span<const emp::block> macVec {
-                        transposedRawMacs.data() + col * transposedCol, transposedCol
-                    };
-
-                    _resFlatMatrix.push_back(_mm_xor_si128(
-                        compressMatrixRow * macVec,
-                        and_all_bits(aMatrix[col], alpha)
-                    ));
-                }
+            _alphas.reserve(matrix.rowSize);
+            for (size_t row {0}; row != matrix.rowSize; ++row) {
+                _alphas.push_back(dualAuthedB.get_local_key(0, row));
             }
         }
 
@@ -89,63 +98,66 @@ namespace ATLab {
             const ITMacBitKeys& aMatrix
         ):
             _circuit {circuit},
-            _totalIndependent {circuit.totalInputSize + circuit.andGateSize}
+            _matrix {matrix},
+            _totalIndependent {circuit.totalInputSize + circuit.andGateSize},
+            _compressParam {matrix.colSize},
+            _rowSum(matrix.blocks_per_row()),
+            _columnSum(_compressParam)
         {
-            const size_t compressParam {matrix.colSize};
-
-            // Transpose aMatrix's keys to easily create a span of columns
-            const size_t&
-                transposedRow {_totalIndependent},
-                transposedCol {compressParam};
-            std::vector<emp::block> transposedRawKeys; // global key major
-            transposedRawKeys.reserve(transposedRow * transposedCol);
-
-            for (size_t i = 0; i < transposedRow; ++i) {
-                for (size_t j = 0; j < transposedCol; ++j) {
-                    transposedRawKeys.push_back(aMatrix.get_local_key(j, i));
-                }
-            }
-
-            const size_t& resMatrixRow {matrix.rowSize}, resMatrixCol {_totalIndependent};
-            _resFlatMatrix.reserve(resMatrixRow * resMatrixCol);
-
-            // <b_i a_j>
-            for (size_t row {0}; row != resMatrixRow; ++row) {
-                const auto compressMatrixRow {matrix.row(row)};
-                for (size_t col {0}; col != resMatrixCol; ++col) {
-                    const boost::span<const emp::block> keyVec {
-                        transposedRawKeys.data() + col * transposedCol, transposedCol
-                    };
-                    // only AND the LSB is enough
-                    _resFlatMatrix.push_back(compressMatrixRow * keyVec);
-                }
-            }
+            // only AND the LSB is enough
+            _transpose(aMatrix, [](const ITMacBitKeys& keys, const size_t j, const size_t i) {
+                return keys.get_local_key(j, i);
+            });
         }
 
         /**
-         * @param a, b must be independent wires
+         * ⊕_{i ∈ S(in0), j ∈ S(in1)} <b_j a_i>, with S(w) the XOR source list of w.
+         * Each term is M_j · mac_i ⊕ a_i α_j, which is bilinear, so the sum is
+         * (⊕_j M_j) · (⊕_i mac_i) ⊕ (⊕_i a_i)(⊕_j α_j): O(|S0| + |S1|) row operations and one inner product.
          */
-        emp::block from_cache(const Wire a, const Wire b) const {
-            if (b < static_cast<Wire>(_circuit.inputSize0)) {
+        emp::block operator()(const Wire in0, const Wire in1) {
+            using Block64 = Matrix<bool>::Block64;
+            const size_t blocksPerRow {_matrix.blocks_per_row()};
+
+            // Rows of the compression matrix over S1. Garbler's input wires have b = 0.
+            std::fill(_rowSum.begin(), _rowSum.end(), 0);
+            emp::block alphaSum {zero_block()};
+            bool hasRow {false};
+            _circuit.xor_source_list(in1).for_each_wire([&](const Wire j) {
+                if (j < static_cast<Wire>(_circuit.inputSize0)) {
+                    return;
+                }
+                const size_t row {_circuit.independent_index_map(j) - _circuit.inputSize0};
+                const Block64* rowData {_matrix.row_data(row)};
+                for (size_t k {0}; k != blocksPerRow; ++k) {
+                    _rowSum[k] ^= rowData[k];
+                }
+                if (!_alphas.empty()) {
+                    xor_to(alphaSum, _alphas[row]);
+                }
+                hasRow = true;
+            });
+            if (!hasRow) {
                 return zero_block();
             }
 
-            const size_t
-                col {_circuit.independent_index_map(a)},
-                row {_circuit.independent_index_map(b) - _circuit.inputSize0};
-
-            // const size_t col {index_map(a)}, row {index_map(b)}; // <b_i a_j>
-            return _resFlatMatrix.at(row * _totalIndependent + col);
-        }
-
-        emp::block operator()(const Wire in0, const Wire in1) const {
-            emp::block res {_mm_set_epi64x(0, 0)};
-            const auto xorSource1 {_circuit.xor_source_list(in1)};
-            _circuit.xor_source_list(in0).for_each_wire([this, &xorSource1, &res](const Wire i) {
-                xorSource1.for_each_wire([this, &res, i](const Wire j) {
-                    xor_to(res, from_cache(i, j));
-                });
+            // Columns of a's macs/keys over S0
+            std::fill(_columnSum.begin(), _columnSum.end(), zero_block());
+            bool aSum {false};
+            _circuit.xor_source_list(in0).for_each_wire([&](const Wire i) {
+                const size_t col {_circuit.independent_index_map(i)};
+                const emp::block* column {_transposedRaw.data() + col * _compressParam};
+                for (size_t k {0}; k != _compressParam; ++k) {
+                    xor_to(_columnSum[k], column[k]);
+                }
+                if (!_alphas.empty()) {
+                    aSum ^= _aBits[col];
+                }
             });
+
+            const Matrix<bool>::RowView aggregatedRow {_rowSum.data(), blocksPerRow, _matrix.colSize};
+            emp::block res {aggregatedRow * _columnSum};
+            xor_to(res, and_all_bits(aSum, alphaSum));
             return res;
         }
     };
@@ -0,0 +1,56 @@
+#ifndef ATLab_SESSION_HPP
+#define ATLab_SESSION_HPP
+
+#include <memory>
+
+#include "cot_backend.hpp"
+#include "net-io.hpp"
+
+namespace ATLab {
+
+    /**
+     * Protocol state of one 2PC session: the COT backends, with their IKNP instances and Δ,
+     * that BlockCorrelatedOT::Sender/Receiver extend from.
+     * Every NetIO owns one (NetIO::session()), so the state is threaded through every protocol function
+     * together with the connection, and a process can run any number of sessions concurrently.
+     * A session must only be used by one thread at a time.
+     */
+    class Session {
+        NetIO& _io;
+        std::unique_ptr<BlockCorrelatedOT::COTSenderBackend> _cotSender;
+        std::unique_ptr<BlockCorrelatedOT::COTReceiverBackend> _cotReceiver;
+
+    public:
+        explicit Session(NetIO& io) noexcept:
+            _io {io}
+        {}
+
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        [[nodiscard]]
+        NetIO& io() const noexcept {
+            return _io;
+        }
+
+        /**
+         * The backends are set up on first use, which runs base OTs with the peer;
+         * the peer must set up the matching backend at the same point of the protocol.
+         */
+        BlockCorrelatedOT::COTSenderBackend& cot_sender() {
+            if (!_cotSender) {
+                _cotSender = BlockCorrelatedOT::make_COT_sender_backend(_io);
+            }
+            return *_cotSender;
+        }
+
+        BlockCorrelatedOT::COTReceiverBackend& cot_receiver() {
+            if (!_cotReceiver) {
+                _cotReceiver = BlockCorrelatedOT::make_COT_receiver_backend(_io);
+            }
+            return *_cotReceiver;
+        }
+    };
+}
+
+#endif // ATLab_SESSION_HPP
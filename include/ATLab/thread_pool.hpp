@@ -0,0 +1,150 @@
+#ifndef ATLab_THREAD_POOL_HPP
+#define ATLab_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ATLab {
+
+    /**
+     * Fixed set of worker threads running `parallel_for` ranges together with the calling thread.
+     * With a thread count of 1 no worker is started and everything runs on the caller.
+     * `parallel_for` is not reentrant and must only be called from the owning thread.
+     */
+    class ThreadPool {
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _taskReady, _taskDone;
+        std::function<void(size_t)> _task; // called with the part index
+        size_t _generation {0}, _pending {0};
+        bool _stopped {false};
+        std::exception_ptr _error;
+
+        void _work(const size_t part) {
+            for (size_t seenGeneration {0};;) {
+                std::function<void(size_t)> task;
+                {
+                    std::unique_lock lock {_mutex};
+                    _taskReady.wait(lock, [this, seenGeneration]() {
+                        return _stopped || _generation != seenGeneration;
+                    });
+                    if (_stopped) {
+                        return;
+                    }
+                    seenGeneration = _generation;
+                    task = _task;
+                }
+                try {
+                    task(part);
+                } catch (...) {
+                    std::lock_guard lock {_mutex};
+                    if (!_error) {
+                        _error = std::current_exception();
+                    }
+                }
+                {
+                    std::lock_guard lock {_mutex};
+                    --_pending;
+                }
+                _taskDone.notify_one();
+            }
+        }
+
+    public:
+        // Ranges shorter than this per thread are run on the caller only
+        static constexpr size_t MIN_ITEMS_PER_THREAD {64};
+
+        /**
+         * @param threadCount total number of threads including the caller, 0 meaning one per hardware thread
+         */
+        explicit ThreadPool(size_t threadCount = 1) {
+            if (threadCount == 0) {
+                threadCount = std::max(1u, std::thread::hardware_concurrency());
+            }
+            _workers.reserve(threadCount - 1);
+            for (size_t part {1}; part != threadCount; ++part) {
+                _workers.emplace_back(&ThreadPool::_work, this, part);
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock {_mutex};
+                _stopped = true;
+            }
+            _taskReady.notify_all();
+            for (auto& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        [[nodiscard]]
+        size_t size() const noexcept {
+            return _workers.size() + 1;
+        }
+
+        /**
+         * Calls `fn(i)` for every i in [begin, end), splitting the range into contiguous parts.
+         * Returns once all calls finished; the first exception thrown by any call is rethrown.
+         */
+        template <typename Func>
+        void parallel_for(const size_t begin, const size_t end, Func&& fn) {
+            const size_t total {end - begin};
+            const size_t parts {std::min(size(), total / MIN_ITEMS_PER_THREAD)};
+            if (parts <= 1) {
+                for (size_t i {begin}; i != end; ++i) {
+                    fn(i);
+                }
+                return;
+            }
+
+            auto run_part {[begin, total, parts, &fn](const size_t part) {
+                if (part >= parts) {
+                    return;
+                }
+                const size_t partEnd {begin + total * (part + 1) / parts};
+                for (size_t i {begin + total * part / parts}; i != partEnd; ++i) {
+                    fn(i);
+                }
+            }};
+            {
+                std::lock_guard lock {_mutex};
+                _task = run_part;
+                _pending = _workers.size();
+                _error = nullptr;
+                ++_generation;
+            }
+            _taskReady.notify_all();
+
+            std::exception_ptr callerError;
+            try {
+                run_part(0);
+            } catch (...) {
+                callerError = std::current_exception();
+            }
+
+            std::unique_lock lock {_mutex};
+            _taskDone.wait(lock, [this]() {
+                return _pending == 0;
+            });
+            _task = nullptr;
+            if (callerError) {
+                std::rethrow_exception(callerError);
+            }
+            if (_error) {
+                std::rethrow_exception(_error);
+            }
+        }
+    };
+}
+
+#endif // ATLab_THREAD_POOL_HPP
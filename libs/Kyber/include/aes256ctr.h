@@ -24,6 +24,14 @@ void aes256ctr_squeezeblocks(uint8_t *out,
                              size_t nblocks,
                              aes256ctr_ctx *state);
 
+#define aes256ctr_squeezeblocks_x4 AES256CTR_NAMESPACE(_squeezeblocks_x4)
+void aes256ctr_squeezeblocks_x4(uint8_t *out0,
+                                uint8_t *out1,
+                                uint8_t *out2,
+                                uint8_t *out3,
+                                size_t nblocks,
+                                aes256ctr_ctx state[4]);
+
 #define aes256ctr_prf AES256CTR_NAMESPACE(_prf)
 void aes256ctr_prf(uint8_t *out,
                    size_t outlen,
@@ -7,16 +7,32 @@
 
 #define gen_matrix KYBER_NAMESPACE(_gen_matrix)
 void gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed);
+#define gen_matrix_x4 KYBER_NAMESPACE(_gen_matrix_x4)
+void gen_matrix_x4(polyvec *a[4], const uint8_t *seed[4], int transposed, unsigned int rows);
 #define indcpa_keypair KYBER_NAMESPACE(_indcpa_keypair)
 void indcpa_keypair(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                     uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
 
+#define indcpa_keypair_derand KYBER_NAMESPACE(_indcpa_keypair_derand)
+void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                           uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                           const uint8_t seed[KYBER_SYMBYTES]);
+
+#define indcpa_keypair_x4_derand KYBER_NAMESPACE(_indcpa_keypair_x4_derand)
+void indcpa_keypair_x4_derand(uint8_t *pk[4], uint8_t *sk[4], const uint8_t *seed[4]);
+
 #define indcpa_enc KYBER_NAMESPACE(_indcpa_enc)
 void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
                 const uint8_t m[KYBER_INDCPA_MSGBYTES],
                 const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                 const uint8_t coins[KYBER_SYMBYTES]);
 
+#define indcpa_enc_x4 KYBER_NAMESPACE(_indcpa_enc_x4)
+void indcpa_enc_x4(uint8_t *c[4],
+                   const uint8_t *m[4],
+                   const uint8_t *pk[4],
+                   const uint8_t *coins[4]);
+
 #define indcpa_dec KYBER_NAMESPACE(_indcpa_dec)
 void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
                 const uint8_t c[KYBER_INDCPA_BYTES],
@@ -57,6 +57,41 @@ static inline void aesni_encrypt4(uint8_t out[64],
   _mm_storeu_si128((__m128i*)(out+48),f3);
 }
 
+/* Same output as aesni_encrypt4 on each of 4 independent states, 16 blocks interleaved */
+static inline void aesni_encrypt4_x4(uint8_t *out[4], aes256ctr_ctx state[4])
+{
+  __m128i f[4][4], n, t;
+  unsigned int i, j, k;
+
+  t = _mm_set_epi8(8,9,10,11,12,13,14,15,7,6,5,4,3,2,1,0);
+  for(j=0;j<4;j++) {
+    n = _mm_load_si128(&state[j].n);
+    for(k=0;k<4;k++)
+      f[j][k] = _mm_shuffle_epi8(_mm_add_epi64(n,_mm_set_epi64x(k,0)),t);
+    _mm_store_si128(&state[j].n,_mm_add_epi64(n,_mm_set_epi64x(4,0)));
+  }
+
+  for(j=0;j<4;j++) {
+    t = _mm_load_si128(&state[j].rkeys[0]);
+    for(k=0;k<4;k++)
+      f[j][k] = _mm_xor_si128(f[j][k],t);
+  }
+
+  for(i=1;i<14;i++) {
+    for(j=0;j<4;j++) {
+      t = _mm_load_si128(&state[j].rkeys[i]);
+      for(k=0;k<4;k++)
+        f[j][k] = _mm_aesenc_si128(f[j][k],t);
+    }
+  }
+
+  for(j=0;j<4;j++) {
+    t = _mm_load_si128(&state[j].rkeys[14]);
+    for(k=0;k<4;k++)
+      _mm_storeu_si128((__m128i*)(out[j]+16*k),_mm_aesenclast_si128(f[j][k],t));
+  }
+}
+
 void aes256ctr_init(aes256ctr_ctx *state, const uint8_t key[32], uint64_t nonce)
 {
   __m128i key0, key1, temp0, temp1, temp2, temp4;
@@ -124,6 +159,24 @@ void aes256ctr_squeezeblocks(uint8_t *out,
   }
 }
 
+void aes256ctr_squeezeblocks_x4(uint8_t *out0,
+                                uint8_t *out1,
+                                uint8_t *out2,
+                                uint8_t *out3,
+                                size_t nblocks,
+                                aes256ctr_ctx state[4])
+{
+  size_t i;
+  uint8_t *out[4] = {out0, out1, out2, out3};
+  for(i=0;i<nblocks;i++) {
+    aesni_encrypt4_x4(out, state);
+    out[0] += 64;
+    out[1] += 64;
+    out[2] += 64;
+    out[3] += 64;
+  }
+}
+
 void aes256ctr_prf(uint8_t *out,
                    size_t outlen,
                    const uint8_t seed[32],
@@ -476,6 +476,141 @@ void gen_matrix(polyvec *a, const uint8_t seed[32], int transposed)
 #endif
 #endif
 
+/*************************************************
+* Name:        gen_matrix_x4
+*
+* Description: gen_matrix for 4 independent seeds, with the XOF outputs
+*              of the 4 instances generated together
+*
+* Arguments:   - polyvec *a[4]: pointers to the 4 output matrices
+*              - const uint8_t *seed[4]: pointers to the 4 input seeds
+*              - int transposed: boolean deciding whether A or A^T is generated
+*              - unsigned int rows: number of leading rows to generate,
+*                KYBER_K for the whole matrix
+**************************************************/
+#ifdef KYBER_90S
+#define GEN_MATRIX_X4_BUFLEN ((AVX_REJ_UNIFORM_BUFLEN+2+31)/32*32)
+void gen_matrix_x4(polyvec *a[4], const uint8_t *seed[4], int transposed, unsigned int rows)
+{
+  unsigned int ctr, i, j, k, l;
+  unsigned buflen, off;
+  __attribute__((aligned(16)))
+  uint64_t nonce;
+  __attribute__((aligned(32)))
+  uint8_t buf[4][GEN_MATRIX_X4_BUFLEN];
+  aes256ctr_ctx state[4];
+
+  for(l=0;l<4;l++)
+    aes256ctr_init(&state[l], seed[l], 0);
+
+  for(i=0;i<rows;i++) {
+    for(j=0;j<KYBER_K;j++) {
+      if(transposed)
+        nonce = (j << 8) | i;
+      else
+        nonce = (i << 8) | j;
+
+      for(l=0;l<4;l++)
+        state[l].n = _mm_loadl_epi64((__m128i *)&nonce);
+      aes256ctr_squeezeblocks_x4(buf[0], buf[1], buf[2], buf[3], GEN_MATRIX_NBLOCKS, state);
+
+      for(l=0;l<4;l++) {
+        buflen = GEN_MATRIX_NBLOCKS*XOF_BLOCKBYTES;
+        ctr = rej_uniform_avx(a[l][i].vec[j].coeffs, buf[l]);
+
+        // rarely needed, continues the stream of instance l alone
+        while(ctr < KYBER_N) {
+          off = buflen % 3;
+          for(k = 0; k < off; k++)
+            buf[l][k] = buf[l][buflen - off + k];
+          aes256ctr_squeezeblocks(buf[l] + off, 1, &state[l]);
+          buflen = off + XOF_BLOCKBYTES;
+          ctr += rej_uniform(a[l][i].vec[j].coeffs + ctr, KYBER_N - ctr, buf[l], buflen);
+        }
+
+        poly_nttunpack(&a[l][i].vec[j]);
+      }
+    }
+  }
+}
+#else
+void gen_matrix_x4(polyvec *a[4], const uint8_t *seed[4], int transposed, unsigned int rows)
+{
+  unsigned int l;
+  (void)rows;
+  for(l=0;l<4;l++)
+    gen_matrix(a[l], seed[l], transposed);
+}
+#endif
+
+/*************************************************
+* Name:        keypair_from_noise
+*
+* Description: Rest of key generation once the matrix and the noise are sampled
+**************************************************/
+static void keypair_from_noise(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                               uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                               polyvec a[KYBER_K],
+                               polyvec *skpv,
+                               polyvec *e,
+                               const uint8_t publicseed[KYBER_SYMBYTES])
+{
+  unsigned int i;
+  polyvec pkpv;
+
+  polyvec_ntt(skpv);
+  polyvec_reduce(skpv);
+  polyvec_ntt(e);
+
+  // matrix-vector multiplication
+  for(i=0;i<KYBER_K;i++) {
+    polyvec_pointwise_acc_montgomery(&pkpv.vec[i], &a[i], skpv);
+    poly_tomont(&pkpv.vec[i]);
+  }
+
+  polyvec_add(&pkpv, &pkpv, e);
+  polyvec_reduce(&pkpv);
+
+  pack_sk(sk, skpv);
+  pack_pk(pk, &pkpv, publicseed);
+}
+
+/*************************************************
+* Name:        enc_from_noise
+*
+* Description: Rest of encryption once the matrix and the noise are sampled
+**************************************************/
+static void enc_from_noise(uint8_t c[KYBER_INDCPA_BYTES],
+                           polyvec at[KYBER_K],
+                           polyvec *pkpv,
+                           polyvec *sp,
+                           polyvec *ep,
+                           poly *epp,
+                           poly *k)
+{
+  unsigned int i;
+  polyvec bp;
+  poly v;
+
+  polyvec_ntt(sp);
+
+  // matrix-vector multiplication
+  for(i=0;i<KYBER_K;i++)
+    polyvec_pointwise_acc_montgomery(&bp.vec[i], &at[i], sp);
+  polyvec_pointwise_acc_montgomery(&v, pkpv, sp);
+
+  polyvec_invntt_tomont(&bp);
+  poly_invntt_tomont(&v);
+
+  polyvec_add(&bp, &bp, ep);
+  poly_add(&v, &v, epp);
+  poly_add(&v, &v, k);
+  polyvec_reduce(&bp);
+  poly_reduce(&v);
+
+  pack_ciphertext(c, &bp, &v);
+}
+
 /*************************************************
 * Name:        indcpa_keypair
 *
@@ -489,6 +624,25 @@ void gen_matrix(polyvec *a, const uint8_t seed[32], int transposed)
 **************************************************/
 void indcpa_keypair(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                     uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  uint8_t seed[KYBER_SYMBYTES];
+  randombytes(seed, KYBER_SYMBYTES);
+  indcpa_keypair_derand(pk, sk, seed);
+}
+
+/*************************************************
+* Name:        indcpa_keypair_derand
+*
+* Description: indcpa_keypair with the randomness given by the caller
+*
+* Arguments:   - uint8_t *pk: pointer to output public key
+*              - uint8_t *sk: pointer to output private key
+*              - const uint8_t *seed: pointer to input randomness
+*                                     (of length KYBER_SYMBYTES bytes)
+**************************************************/
+void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                           uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                           const uint8_t seed[KYBER_SYMBYTES])
 {
   unsigned int i;
   __attribute__((aligned(32)))
@@ -497,7 +651,8 @@ void indcpa_keypair(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
   const uint8_t *noiseseed = buf+KYBER_SYMBYTES;
   polyvec a[KYBER_K], e, pkpv, skpv;
 
-  randombytes(buf, KYBER_SYMBYTES);
+  for(i=0;i<KYBER_SYMBYTES;i++)
+    buf[i] = seed[i];
   hash_g(buf, buf, KYBER_SYMBYTES);
 
   gen_a(a, publicseed);
@@ -547,22 +702,73 @@ void indcpa_keypair(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
 #endif
 #endif
 
-  polyvec_ntt(&skpv);
-  polyvec_reduce(&skpv);
-  polyvec_ntt(&e);
+  (void)pkpv;
+  keypair_from_noise(pk, sk, a, &skpv, &e, publicseed);
+}
 
-  // matrix-vector multiplication
-  for(i=0;i<KYBER_K;i++) {
-    polyvec_pointwise_acc_montgomery(&pkpv.vec[i], &a[i], &skpv);
-    poly_tomont(&pkpv.vec[i]);
+/*************************************************
+* Name:        indcpa_keypair_x4_derand
+*
+* Description: indcpa_keypair_derand for 4 independent key pairs, with the
+*              matrix expansion and the noise sampling done for all 4 together
+**************************************************/
+#ifdef KYBER_90S
+void indcpa_keypair_x4_derand(uint8_t *pk[4], uint8_t *sk[4], const uint8_t *seed[4])
+{
+  unsigned int i, l;
+  __attribute__((aligned(32)))
+  uint8_t buf[4][2*KYBER_SYMBYTES];
+  const uint8_t *publicseed[4];
+  polyvec a[4][KYBER_K], e[4], skpv[4];
+  polyvec *ap[4] = {a[0], a[1], a[2], a[3]};
+
+  for(l=0;l<4;l++) {
+    for(i=0;i<KYBER_SYMBYTES;i++)
+      buf[l][i] = seed[l][i];
+    hash_g(buf[l], buf[l], KYBER_SYMBYTES);
+    publicseed[l] = buf[l];
   }
 
-  polyvec_add(&pkpv, &pkpv, &e);
-  polyvec_reduce(&pkpv);
+  gen_matrix_x4(ap, publicseed, 0, KYBER_K);
 
-  pack_sk(sk, &skpv);
-  pack_pk(pk, &pkpv, publicseed);
+#define NBLOCKS ((2*KYBER_ETA1*32)/AES256CTR_BLOCKBYTES ) /* Assumes divisibility */
+#define NOISE_X4_BUFLEN ((AES256CTR_BLOCKBYTES*NBLOCKS+2+31)/32*32) /* +2 as required by cbd3 */
+  __attribute__((aligned(16)))
+  uint64_t nonce = 0;
+  aes256ctr_ctx state[4];
+  __attribute__((aligned(32)))
+  uint8_t noise[4][NOISE_X4_BUFLEN];
+  for(l=0;l<4;l++)
+    aes256ctr_init(&state[l], buf[l]+KYBER_SYMBYTES, nonce);
+  nonce++;
+  for(i=0;i<KYBER_K;i++) {
+    aes256ctr_squeezeblocks_x4(noise[0], noise[1], noise[2], noise[3], NBLOCKS, state);
+    for(l=0;l<4;l++) {
+      state[l].n = _mm_loadl_epi64((__m128i *)&nonce);
+      cbd_eta1(&skpv[l].vec[i], noise[l]);
+    }
+    nonce++;
+  }
+  for(i=0;i<KYBER_K;i++) {
+    aes256ctr_squeezeblocks_x4(noise[0], noise[1], noise[2], noise[3], NBLOCKS, state);
+    for(l=0;l<4;l++) {
+      state[l].n = _mm_loadl_epi64((__m128i *)&nonce);
+      cbd_eta1(&e[l].vec[i], noise[l]);
+    }
+    nonce++;
+  }
+
+  for(l=0;l<4;l++)
+    keypair_from_noise(pk[l], sk[l], a[l], &skpv[l], &e[l], publicseed[l]);
+}
+#else
+void indcpa_keypair_x4_derand(uint8_t *pk[4], uint8_t *sk[4], const uint8_t *seed[4])
+{
+  unsigned int l;
+  for(l=0;l<4;l++)
+    indcpa_keypair_derand(pk[l], sk[l], seed[l]);
 }
+#endif
 
 /*************************************************
 * Name:        indcpa_enc
@@ -590,7 +796,7 @@ void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
   __attribute__((aligned(32)))
   uint8_t seed[KYBER_SYMBYTES];
   polyvec sp, pkpv, ep, at[KYBER_K], bp;
-  poly v, k, epp;
+  poly k, epp;
 
   unpack_pk(&pkpv, seed, pk);
   poly_frommsg(&k, m);
@@ -646,24 +852,78 @@ void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
 #endif
 #endif
 
-  polyvec_ntt(&sp);
-
-  // matrix-vector multiplication
-  for(i=0;i<KYBER_K;i++)
-    polyvec_pointwise_acc_montgomery(&bp.vec[i], &at[i], &sp);
-  polyvec_pointwise_acc_montgomery(&v, &pkpv, &sp);
+  (void)bp;
+  enc_from_noise(c, at, &pkpv, &sp, &ep, &epp, &k);
+}
 
-  polyvec_invntt_tomont(&bp);
-  poly_invntt_tomont(&v);
+/*************************************************
+* Name:        indcpa_enc_x4
+*
+* Description: indcpa_enc for 4 independent encryptions, with the matrix
+*              expansion and the noise sampling done for all 4 together
+**************************************************/
+#ifdef KYBER_90S
+void indcpa_enc_x4(uint8_t *c[4],
+                   const uint8_t *m[4],
+                   const uint8_t *pk[4],
+                   const uint8_t *coins[4])
+{
+  unsigned int i, l;
+  __attribute__((aligned(32)))
+  uint8_t seed[4][KYBER_SYMBYTES];
+  const uint8_t *seedp[4] = {seed[0], seed[1], seed[2], seed[3]};
+  polyvec sp[4], pkpv[4], ep[4], at[4][KYBER_K];
+  polyvec *atp[4] = {at[0], at[1], at[2], at[3]};
+  poly k[4], epp[4];
+
+  for(l=0;l<4;l++) {
+    unpack_pk(&pkpv[l], seed[l], pk[l]);
+    poly_frommsg(&k[l], m[l]);
+  }
+  gen_matrix_x4(atp, seedp, 1, KYBER_K);
 
-  polyvec_add(&bp, &bp, &ep);
-  poly_add(&v, &v, &epp);
-  poly_add(&v, &v, &k);
-  polyvec_reduce(&bp);
-  poly_reduce(&v);
+  __attribute__((aligned(16)))
+  uint64_t nonce = 0;
+  aes256ctr_ctx state[4];
+  __attribute__((aligned(32)))
+  uint8_t noise[4][NOISE_X4_BUFLEN];
+  for(l=0;l<4;l++)
+    aes256ctr_init(&state[l], coins[l], nonce);
+  nonce++;
+  for(i=0;i<KYBER_K;i++) {
+    aes256ctr_squeezeblocks_x4(noise[0], noise[1], noise[2], noise[3], NBLOCKS, state);
+    for(l=0;l<4;l++) {
+      state[l].n = _mm_loadl_epi64((__m128i *)&nonce);
+      cbd_eta1(&sp[l].vec[i], noise[l]);
+    }
+    nonce++;
+  }
+  for(i=0;i<KYBER_K;i++) {
+    aes256ctr_squeezeblocks_x4(noise[0], noise[1], noise[2], noise[3], 2, state);
+    for(l=0;l<4;l++) {
+      state[l].n = _mm_loadl_epi64((__m128i *)&nonce);
+      cbd_eta2(&ep[l].vec[i], noise[l]);
+    }
+    nonce++;
+  }
+  aes256ctr_squeezeblocks_x4(noise[0], noise[1], noise[2], noise[3], 2, state);
+  for(l=0;l<4;l++)
+    cbd_eta2(&epp[l], noise[l]);
 
-  pack_ciphertext(c, &bp, &v);
+  for(l=0;l<4;l++)
+    enc_from_noise(c[l], at[l], &pkpv[l], &sp[l], &ep[l], &epp[l], &k[l]);
 }
+#else
+void indcpa_enc_x4(uint8_t *c[4],
+                   const uint8_t *m[4],
+                   const uint8_t *pk[4],
+                   const uint8_t *coins[4])
+{
+  unsigned int l;
+  for(l=0;l<4;l++)
+    indcpa_enc(c[l], m[l], pk[l], coins[l]);
+}
+#endif
 
 /*************************************************
 * Name:        indcpa_dec
@@ -3,13 +3,13 @@
 
 namespace ATLab {
     namespace Garbler {
-        void online(
+        void online_input(
             ATLab::NetIO& io,
             const Circuit& circuit,
             const GarbledCircuit& gc,
             const PreprocessedData& wireMasks,
             const Bitset& input
-        ) noexcept {
+        ) {
             Bitset maskedValues;
             maskedValues.reserve(circuit.inputSize0);
             for (size_t w {0}; w != circuit.inputSize0; ++w) {
@@ -22,20 +22,20 @@ namespace ATLab {
             std::vector<emp::block> garblerInputLabels;
             garblerInputLabels.reserve(circuit.inputSize0);
             for (size_t w {0}; w != circuit.inputSize0; ++w) {
-                garblerInputLabels.push_back(maskedValues[w] ? gc.label1[w] : gc.label0[w]);
+                garblerInputLabels.push_back(maskedValues[w] ? gc.label1(w) : gc.label0[w]);
             }
             io.send_data(garblerInputLabels.data(), garblerInputLabels.size() * sizeof(emp::block));
 
             if (circuit.inputSize1 != 0) {
                 // send labels for evaluator's inputs
-                BlockCorrelatedOT::OT& ot {BlockCorrelatedOT::Sender::Get_simple_OT(io.role)};
+                BlockCorrelatedOT::OT& ot {io.session().cot_sender().simple_ot()};
                 std::vector<emp::block> evaluatorLabel0(circuit.inputSize1);
                 std::vector<emp::block> evaluatorLabel1(circuit.inputSize1);
                 for (size_t i {0}; i != circuit.inputSize1; ++i) {
                     const Wire wire {static_cast<Wire>(circuit.inputSize0 + i)};
                     const bool garblerMaskShare {wireMasks.masks[wire]};
-                    const auto& labelZero {gc.label0[wire]};
-                    const auto& labelOne {gc.label1[wire]};
+                    const emp::block& labelZero {gc.label0[wire]};
+                    const emp::block labelOne {gc.label1(wire)};
                     if (garblerMaskShare) {
                         evaluatorLabel0[i] = labelOne;
                         evaluatorLabel1[i] = labelZero;
@@ -48,7 +48,14 @@ namespace ATLab {
 
                 wireMasks.masks.open(io, SHA256::hash_to_128, circuit.inputSize0, circuit.totalInputSize);
             }
+        }
 
+        void online_output(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const GarbledCircuit& gc,
+            const PreprocessedData& wireMasks
+        ) {
             Bitset outputMasks;
             outputMasks.reserve(circuit.outputSize);
             for (size_t i {0}; i != circuit.outputSize; ++i) {
@@ -59,15 +66,25 @@ namespace ATLab {
 
             check(io, circuit, wireMasks, gc);
         }
+
+        void online(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const GarbledCircuit& gc,
+            const PreprocessedData& wireMasks,
+            const Bitset& input
+        ) noexcept {
+            online_input(io, circuit, gc, wireMasks, input);
+            online_output(io, circuit, gc, wireMasks);
+        }
     }
 
     namespace Evaluator {
-        Bitset online(
+        EvaluateResult online_input(
             ATLab::NetIO& io,
             const Circuit& circuit,
-            const ReceivedGarbledCircuit& gc,
             const PreprocessedData& wireMasks,
-            Bitset input
+            const Bitset& input
         ) {
             std::vector<BitsetBlock> rawMaskedValues(calc_bitset_block(circuit.inputSize0));
             io.recv_data(rawMaskedValues.data(), rawMaskedValues.size() * sizeof(BitsetBlock));
@@ -80,7 +97,7 @@ namespace ATLab {
 
             if (circuit.inputSize1 != 0) {
                 // OT steps
-                BlockCorrelatedOT::OT& ot {BlockCorrelatedOT::Receiver::Get_simple_OT(io.role)};
+                BlockCorrelatedOT::OT& ot {io.session().cot_receiver().simple_ot()};
                 auto choices = std::make_unique<bool[]>(circuit.inputSize1);
                 for (size_t i {0}; i != circuit.inputSize1; ++i) {
                     const Wire wire {static_cast<Wire>(circuit.inputSize0 + i)};
@@ -96,9 +113,16 @@ namespace ATLab {
                 }
             }
 
-            const auto& [maskedValues, labels] {
-                evaluate(circuit, wireMasks, gc, std::move(inputLabels), std::move(inputMaskedValues))
-            };
+            return {std::move(inputMaskedValues), std::move(inputLabels)};
+        }
+
+        Bitset online_output(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const PreprocessedData& wireMasks,
+            const EvaluateResult& result
+        ) {
+            const auto& [maskedValues, labels] {result};
 
             // Get output masks
             std::vector<BitsetBlock> rawOutputMasks(calc_bitset_block(circuit.outputSize));
@@ -119,5 +143,20 @@ namespace ATLab {
             check(io, circuit, wireMasks, labels, maskedValues);
             return output;
         }
+
+        Bitset online(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const ReceivedGarbledCircuit& gc,
+            const PreprocessedData& wireMasks,
+            Bitset input,
+            const size_t threadCount
+        ) {
+            auto [inputMaskedValues, inputLabels] {online_input(io, circuit, wireMasks, input)};
+            const auto result {
+                evaluate(circuit, wireMasks, gc, std::move(inputLabels), std::move(inputMaskedValues), threadCount)
+            };
+            return online_output(io, circuit, wireMasks, result);
+        }
     }
 }
@@ -20,6 +20,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ostream>
 #include <iomanip>
 #include <cstring>
+#include <vector>
 
 #ifdef DEBUG
 #include <cassert>
@@ -81,30 +82,53 @@ namespace ATLab::EndemicOT {
         return ctxt;
     }
 
+    // OTs generated together by the `_x4` functions of Endemic_OT_C.h
+    constexpr size_t OT_BATCH_WIDTH {4};
+
     void batch_send(ATLab::NetIO& io, const emp::block* data0, const emp::block* data1, const size_t length) {
-        Sender::Data d0, d1;
+        // one round: all receiver messages arrive at once, and all sender messages leave at once
+        std::vector<ReceiverMsg> rMsgs(length);
+        io.recv_data(rMsgs.data(), sizeof(ReceiverMsg) * length);
+
+        // only the first 128 bits of each string are used by `recv`
+        std::vector<NewKyberOTPtxt> ptxts(length);
         for (size_t i{0}; i != length; ++i) {
-            // resetting the last 128 bits is not necessary since `recv` does not use those uninitialized bits
-            memcpy(&d0, &data0[i], sizeof(__m128i));
-            memcpy(&d1, &data1[i], sizeof(__m128i));
-            Sender sender(d0, d1);
-            ReceiverMsg rMsg;
-            io.recv_data(&rMsg, sizeof(rMsg));
-            auto sMsg{sender.encrypt_with(rMsg)};
-            io.send_data(&sMsg, sizeof(sMsg));
+            memcpy(ptxts[i].sot[0], &data0[i], sizeof(__m128i));
+            memcpy(ptxts[i].sot[1], &data1[i], sizeof(__m128i));
+        }
+
+        std::vector<SenderMsg> sMsgs(length);
+        size_t i{0};
+        for (; i + OT_BATCH_WIDTH <= length; i += OT_BATCH_WIDTH) {
+            gen_sender_message_x4(&sMsgs[i], &ptxts[i], &rMsgs[i]);
+        }
+        for (; i != length; ++i) {
+            gen_sender_message(&sMsgs[i], &ptxts[i], &rMsgs[i]);
         }
+        io.send_data(sMsgs.data(), sizeof(SenderMsg) * length);
     }
 
 
     void batch_receive(ATLab::NetIO& io, emp::block* data, const bool* const choices, const size_t length) {
+        std::vector<NewKyberOTRecver> receivers(length);
+        std::vector<ReceiverMsg> rMsgs(length);
         for (size_t i{0}; i != length; ++i) {
-            Receiver receiver(choices[i]);
-            auto rMsg{receiver.get_receiver_msg()};
-            io.send_data(&rMsg, sizeof(rMsg));
-            SenderMsg sMsg;
-            io.recv_data(&sMsg, sizeof(sMsg));
-            auto decryptedData{receiver.decrypt_chosen(sMsg)};
-            memcpy(&data[i], &decryptedData, sizeof(__m128i));
+            receivers[i].b = choices[i];
+        }
+        size_t i{0};
+        for (; i + OT_BATCH_WIDTH <= length; i += OT_BATCH_WIDTH) {
+            gen_receiver_message_x4(&receivers[i], &rMsgs[i]);
+        }
+        for (; i != length; ++i) {
+            gen_receiver_message(&receivers[i], &rMsgs[i]);
+        }
+        io.send_data(rMsgs.data(), sizeof(ReceiverMsg) * length);
+
+        std::vector<SenderMsg> sMsgs(length);
+        io.recv_data(sMsgs.data(), sizeof(SenderMsg) * length);
+        for (i = 0; i != length; ++i) {
+            decrypt_received_data(&receivers[i], &sMsgs[i]);
+            memcpy(&data[i], receivers[i].rot, sizeof(__m128i));
         }
     }
 }
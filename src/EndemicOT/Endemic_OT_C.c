@@ -89,6 +89,92 @@ void gen_sender_message(
     indcpa_enc(ctxt->sm[1], ptxt->sot[1], pk, coins);
 }
 
+void gen_receiver_message_x4(NewKyberOTRecver recver[4], EndemicOTReceiverMsg pks[4]) {
+    uint8_t pk[4][PKlength];
+    uint8_t h[4][PKlength];
+    // key pair seed, then the seed of the random public key, of every OT
+    uint8_t seeds[4][2][KYBER_SYMBYTES];
+    uint8_t* pkp[4];
+    uint8_t* skp[4];
+    uint8_t* randomPks[4];
+    uint8_t* hp[4];
+    const uint8_t* keySeeds[4];
+    const uint8_t* pkSeeds[4];
+    const uint8_t* randomSeeds[4];
+    const uint8_t* randomPkSrc[4];
+    size_t i;
+
+    randombytes(&seeds[0][0][0], sizeof(seeds));
+    for (i = 0; i != 4; ++i) {
+        pkp[i] = pk[i];
+        skp[i] = recver[i].secretKey;
+        keySeeds[i] = seeds[i][0];
+        randomSeeds[i] = seeds[i][1];
+        pkSeeds[i] = &pk[i][KYBER_POLYVECBYTES];
+        randomPks[i] = pks[i].keys[1 ^ recver[i].b];
+        randomPkSrc[i] = randomPks[i];
+        hp[i] = h[i];
+    }
+
+    //get pk, sk
+    indcpa_keypair_x4_derand(pkp, skp, keySeeds);
+
+    // sample random public keys for the ones we dont want.
+    randomPK_x4(randomPks, randomSeeds, pkSeeds);
+
+    //compute H(r_{not b})
+    pkHash_x4(hp, randomPkSrc, pkSeeds);
+
+    //set r_b=pk-H(r_{not b})
+    for (i = 0; i != 4; ++i) {
+        pkMinus(pks[i].keys[recver[i].b], pk[i], h[i]);
+    }
+}
+
+void gen_sender_message_x4(
+    EndemicOTSenderMsg ctxt[4],
+    const NewKyberOTPtxt ptxt[4],
+    const EndemicOTReceiverMsg recvPks[4]
+) {
+    unsigned char h[4][PKlength];
+    unsigned char pk[2][4][PKlength];
+    // coins of the encryptions to pk_0, then to pk_1, of every OT
+    unsigned char coins[2][4][Coinslength];
+    uint8_t* hp[4];
+    const uint8_t* seeds[4];
+    const uint8_t* hashed[4];
+    uint8_t* ctxts[4];
+    const uint8_t* msgs[4];
+    const uint8_t* pks[4];
+    const uint8_t* coinsp[4];
+    size_t i, b;
+
+    randombytes(&coins[0][0][0], sizeof(coins));
+    for (i = 0; i != 4; ++i) {
+        hp[i] = h[i];
+        seeds[i] = recvPks[i].keys[0] + KYBER_POLYVECBYTES;
+    }
+    for (b = 0; b != 2; ++b) {
+        //compute pk_b=r_b+h(r_{1-b})
+        for (i = 0; i != 4; ++i) {
+            hashed[i] = recvPks[i].keys[1 ^ b];
+        }
+        pkHash_x4(hp, hashed, seeds);
+        for (i = 0; i != 4; ++i) {
+            pkPlus(pk[b][i], recvPks[i].keys[b], h[i]);
+        }
+
+        //enc
+        for (i = 0; i != 4; ++i) {
+            ctxts[i] = ctxt[i].sm[b];
+            msgs[i] = ptxt[i].sot[b];
+            pks[i] = pk[b][i];
+            coinsp[i] = coins[b][i];
+        }
+        indcpa_enc_x4(ctxts, msgs, pks, coinsp);
+    }
+}
+
 void decrypt_received_data(NewKyberOTRecver* recver, const EndemicOTSenderMsg* ctxt) {
     indcpa_dec(recver->rot, ctxt->sm[recver->b], recver->secretKey);
 }
@@ -128,3 +128,25 @@ void randomPK(uint8_t* pk, const uint8_t* seed1, const uint8_t* seed2) {
     gen_matrix(a, seed1, 0);
     pack_pk(pk, &a[0], seed2);
 }
+
+void pkHash_x4(uint8_t* output[4], const uint8_t* pk[4], const uint8_t* pkSeed[4]) {
+    uint8_t rawHashOutput[4][KYBER_SYMBYTES];
+    const uint8_t* seeds[4];
+    size_t i;
+    for (i = 0; i != 4; ++i) {
+        hash_h(&rawHashOutput[i][0], pk[i], KYBER_POLYVECBYTES);
+        seeds[i] = &rawHashOutput[i][0];
+    }
+    randomPK_x4(output, seeds, pkSeed);
+}
+
+void randomPK_x4(uint8_t* pk[4], const uint8_t* seed1[4], const uint8_t* seed2[4]) {
+    // only the first row is used, as by `randomPK`
+    polyvec a[4][KYBER_K];
+    polyvec* rows[4] = {a[0], a[1], a[2], a[3]};
+    size_t i;
+    gen_matrix_x4(rows, seed1, 0, 1);
+    for (i = 0; i != 4; ++i) {
+        pack_pk(pk[i], &a[i][0], seed2[i]);
+    }
+}
@@ -30,7 +30,7 @@ extern "C" {
 }
 
 namespace ATLab {
-    emp::PRG THE_GLOBAL_PRNG;
+    thread_local emp::PRG THE_GLOBAL_PRNG;
 
     PRNG_Kyber& PRNG_Kyber::get_PRNG_Kyber() {
         static PRNG_Kyber KyberInstance; // state stored in rng.c
@@ -56,16 +56,34 @@ namespace ATLab {
 		}
 #endif // DEBUG
 
+		GateArrays to_gate_arrays(const std::vector<Gate>& gates) {
+			GateArrays arrays;
+			arrays.types.reserve(gates.size());
+			arrays.in0.reserve(gates.size());
+			arrays.in1.reserve(gates.size());
+			arrays.out.reserve(gates.size());
+			for (const auto& gate : gates) {
+				arrays.types.push_back(gate.type);
+				arrays.in0.push_back(gate.in0);
+				arrays.in1.push_back(gate.in1);
+				arrays.out.push_back(gate.out);
+			}
+			return arrays;
+		}
+
 		void map_wires_order_gates (
 			const std::vector<Gate>& gates,
-			std::unordered_map<Wire, size_t>& outputWireToGateIndex,
+			std::vector<uint32_t>& outputWireToGateIndex,
 			std::vector<size_t>& andGateOrder,
 			std::vector<size_t>& andToGlobalIndex
 		) {
 			size_t currentAndOrder {0};
 			for (size_t gateIter {0}; gateIter != gates.size(); ++gateIter) {
 				const auto& gate {gates[gateIter]};
-				outputWireToGateIndex[gate.out] = gateIter;
+				if (gate.out < 0 || static_cast<size_t>(gate.out) >= outputWireToGateIndex.size()) {
+					throw std::runtime_error{"Gate output wire out of range"};
+				}
+				outputWireToGateIndex[gate.out] = static_cast<uint32_t>(gateIter);
 
 				if (gate.is_and()) {
 					andGateOrder[gateIter] = currentAndOrder;
@@ -77,24 +95,146 @@ namespace ATLab {
 	}
 
 	void Circuit::_init_gc_check_data() {
-		_gcCheckData.resize(totalInputSize + andGateSize);
+		// A wire in both source lists of a gate gets one entry, detected by the last gate touching its row
+		constexpr uint32_t NONE {std::numeric_limits<uint32_t>::max()};
+		const size_t rowSize {independent_size()};
+		std::vector<uint32_t> lastAndOrder(rowSize, NONE);
+
+		_gcCheckOffsets.assign(rowSize + 1, 0);
+		for (size_t andOrder {0}; andOrder != andGateSize; ++andOrder) {
+			const auto& gate {and_gate(andOrder)};
+			auto count {[&, this](const Wire w) {
+				const size_t row {independent_index_map(w)};
+				if (lastAndOrder[row] != andOrder) {
+					lastAndOrder[row] = static_cast<uint32_t>(andOrder);
+					++_gcCheckOffsets[row + 1];
+				}
+			}};
+			xor_source_list(gate.in0).for_each_wire(count);
+			xor_source_list(gate.in1).for_each_wire(count);
+		}
+		for (size_t row {0}; row != rowSize; ++row) {
+			_gcCheckOffsets[row + 1] += _gcCheckOffsets[row];
+		}
+
+		// AND gates are visited in order, so every row ends up sorted
+		_gcCheckAndOrders.resize(_gcCheckOffsets[rowSize]);
+		_gcCheckConnections.resize(_gcCheckOffsets[rowSize]);
+		std::vector<size_t> cursor(_gcCheckOffsets.begin(), _gcCheckOffsets.end() - 1);
+		for (size_t andOrder {0}; andOrder != andGateSize; ++andOrder) {
+			const auto& gate {and_gate(andOrder)};
+			auto connect {[&, this](const Wire w, const uint8_t connection) {
+				const size_t row {independent_index_map(w)};
+				size_t& next {cursor[row]};
+				if (next != _gcCheckOffsets[row] && _gcCheckAndOrders[next - 1] == andOrder) {
+					_gcCheckConnections[next - 1] |= connection;
+				} else {
+					_gcCheckAndOrders[next] = static_cast<uint32_t>(andOrder);
+					_gcCheckConnections[next] = connection;
+					++next;
+				}
+			}};
+			xor_source_list(gate.in0).for_each_wire([&connect](const Wire w) {
+				connect(w, GCCheckRow::GC_CHECK_IN0);
+			});
+			xor_source_list(gate.in1).for_each_wire([&connect](const Wire w) {
+				connect(w, GCCheckRow::GC_CHECK_IN1);
+			});
+		}
+	}
+
+	void Circuit::_init_level_schedule() {
+		// AND-depth of every wire, and the level of every gate
+		std::vector<uint32_t> wireDepth(wireSize, 0), gateLevel(gateSize);
+		uint32_t maxLevel {0};
 		for (size_t gateIter {0}; gateIter != gateSize; ++gateIter) {
 			const auto& gate {gates[gateIter]};
-			if (!gate.is_and()) {
-				continue;
+			uint32_t level {wireDepth[gate.in0]};
+			if (gate.type != Gate::Type::NOT) {
+				level = std::max(level, wireDepth[gate.in1]);
 			}
-			xor_source_list(gate.in0).for_each_wire([gateIter, this](const Wire w) {
-				const size_t independentIndex {independent_index_map(w)};
-				_gcCheckData[independentIndex][gateIter] = std::bitset<2>{1};
-			});
-			xor_source_list(gate.in1).for_each_wire([gateIter, this](const Wire w) {
-				const size_t independentIndex {independent_index_map(w)};
-				auto [it, inserted] {_gcCheckData[independentIndex].try_emplace(gateIter, 0)};
-				it->second[1] = true;
-			});
+			gateLevel[gateIter] = level;
+			wireDepth[gate.out] = gate.is_and() ? level + 1 : level;
+			maxLevel = std::max(maxLevel, level);
+		}
+
+		const size_t levelSize {gateSize ? maxLevel + size_t{1} : 0};
+		std::vector<size_t> linearCount(levelSize, 0), andCount(levelSize, 0);
+		for (size_t gateIter {0}; gateIter != gateSize; ++gateIter) {
+			++(gates[gateIter].is_and() ? andCount : linearCount)[gateLevel[gateIter]];
+		}
+
+		_levelBegin.resize(levelSize + 1);
+		_levelAndBegin.resize(levelSize);
+		_levelBegin[0] = 0;
+		for (size_t l {0}; l != levelSize; ++l) {
+			_levelAndBegin[l] = _levelBegin[l] + linearCount[l];
+			_levelBegin[l + 1] = _levelAndBegin[l] + andCount[l];
+		}
+
+		// stable bucketing keeps circuit order inside every group
+		std::vector<size_t> linearCursor(_levelBegin.begin(), _levelBegin.end() - 1), andCursor {_levelAndBegin};
+		_levelGates.resize(gateSize);
+		for (size_t gateIter {0}; gateIter != gateSize; ++gateIter) {
+			auto& cursor {(gates[gateIter].is_and() ? andCursor : linearCursor)[gateLevel[gateIter]]};
+			_levelGates[cursor++] = gateIter;
 		}
 	}
 
+	void Circuit::_init_label_slots() {
+		constexpr size_t NEVER {std::numeric_limits<size_t>::max()};
+
+		// Position of the last reader of every wire in schedule order
+		std::vector<size_t> lastUse(wireSize, NEVER);
+		for (size_t position {0}; position != gateSize; ++position) {
+			const auto& gate {gates[_levelGates[position]]};
+			lastUse[gate.in0] = position;
+			if (gate.type != Gate::Type::NOT) {
+				lastUse[gate.in1] = position;
+			}
+		}
+
+		// Inputs, AND outputs and circuit outputs are read after evaluation, by online or check
+		const size_t firstOutputWire {wireSize - outputSize};
+		auto is_pinned {[this, firstOutputWire](const Wire w) {
+			return w < static_cast<Wire>(totalInputSize) || static_cast<size_t>(w) >= firstOutputWire
+				|| gates[gate_index_by_output_wire(w)].is_and();
+		}};
+
+		_labelSlot.assign(wireSize, 0);
+		std::vector<uint32_t> freeSlots;
+		size_t slotSize {totalInputSize};
+		for (size_t w {0}; w != totalInputSize; ++w) {
+			_labelSlot[w] = static_cast<uint32_t>(w);
+		}
+		auto release {[&](const Wire w, const size_t position) {
+			if (lastUse[w] == position && !is_pinned(w)) {
+				freeSlots.push_back(_labelSlot[w]);
+			}
+		}};
+
+		for (size_t position {0}; position != gateSize; ++position) {
+			const auto& gate {gates[_levelGates[position]]};
+			// Inputs are released first: linear gates may write their output over an input
+			// they read, and AND outputs are pinned, so nothing of the running level is overwritten
+			release(gate.in0, position);
+			if (gate.type != Gate::Type::NOT && gate.in1 != gate.in0) {
+				release(gate.in1, position);
+			}
+
+			if (is_pinned(gate.out) || freeSlots.empty()) {
+				_labelSlot[gate.out] = static_cast<uint32_t>(slotSize++);
+			} else {
+				_labelSlot[gate.out] = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			if (lastUse[gate.out] == NEVER && !is_pinned(gate.out)) {
+				freeSlots.push_back(_labelSlot[gate.out]);
+			}
+		}
+		_labelSlotSize = slotSize;
+	}
+
 	void Circuit::Populate_XOR_source_matrix_(const std::vector<Gate>& gates, XORSourceMatrix& xorSourceMatrix,
 		const size_t totalInputSize, const size_t wireSize) {
 		const size_t inputInitLimit {std::min(totalInputSize, wireSize)};
@@ -127,7 +267,10 @@ namespace ATLab {
 		gates.reserve(gateSize);
 		_andGateOrder.resize(gateSize, AND_ORDER_DISABLED);
 		_xorSourceMatrix._initialize(wireSize);
-		_outputWireToGateIndex.reserve(gateSize);
+		if (gateSize >= NO_SOURCE_GATE) {
+			throw std::runtime_error{"Circuit has too many gates"};
+		}
+		_outputWireToGateIndex.resize(wireSize, NO_SOURCE_GATE);
 
 		fin >> inputSize0 >> inputSize1 >> outputSize;
 		totalInputSize = inputSize0 + inputSize1;
@@ -163,6 +306,7 @@ namespace ATLab {
 			}
 		}
 		_andToGlobalIndex.resize(andGateSize);
+		gateArrays = to_gate_arrays(gates);
 
 		map_wires_order_gates(gates, _outputWireToGateIndex, _andGateOrder, _andToGlobalIndex);
 
@@ -174,6 +318,8 @@ namespace ATLab {
 		);
 
 		_init_gc_check_data();
+		_init_level_schedule();
+		_init_label_slots();
 	}
 
 	size_t Circuit::and_gate_order(const size_t gateIndex) const {
@@ -0,0 +1,355 @@
+#include <../include/ATLab/circuit_parser.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * Binary circuit layout, all native-endian:
+ *   BinaryHeader
+ *   arrays in the order of `Circuit::save`, each as a uint64_t element count followed by the elements,
+ *   zero-padded to a multiple of ARRAY_ALIGNMENT bytes
+ */
+
+namespace ATLab {
+	namespace {
+		static_assert(sizeof(size_t) == sizeof(uint64_t), "The binary circuit format stores size_t as 64 bits");
+
+		constexpr std::array<char, 8> BINARY_MAGIC {'A', 'T', 'L', 'a', 'b', 'C', 'I', 'R'};
+		constexpr uint32_t BYTE_ORDER_MARK {0x01020304};
+		constexpr size_t ARRAY_ALIGNMENT {8};
+
+		struct BinaryHeader {
+			std::array<char, 8> magic;
+			uint32_t version;
+			uint32_t byteOrder;
+			uint64_t gateSize, wireSize, inputSize0, inputSize1, outputSize, andGateSize, labelSlotSize;
+		};
+		static_assert(std::is_trivially_copyable_v<BinaryHeader>);
+
+		template <typename T>
+		void write_array(std::ofstream& fout, const std::vector<T>& array) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const uint64_t size {array.size()};
+			fout.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			fout.write(reinterpret_cast<const char*>(array.data()), static_cast<std::streamsize>(size * sizeof(T)));
+
+			constexpr std::array<char, ARRAY_ALIGNMENT> padding {};
+			const size_t tail {size * sizeof(T) % ARRAY_ALIGNMENT};
+			if (tail) {
+				fout.write(padding.data(), static_cast<std::streamsize>(ARRAY_ALIGNMENT - tail));
+			}
+		}
+
+		// Read-only mapping of a whole file, unmapped on destruction
+		class MappedFile {
+			const char* _data {nullptr};
+			size_t _size {0};
+
+		public:
+			explicit MappedFile(const std::string& filename) {
+				const int fd {::open(filename.c_str(), O_RDONLY)};
+				if (fd < 0) {
+					throw std::runtime_error{"Cannot open file " + filename};
+				}
+				struct stat fileStat {};
+				if (::fstat(fd, &fileStat) != 0) {
+					::close(fd);
+					throw std::runtime_error{"Cannot stat file " + filename};
+				}
+				_size = static_cast<size_t>(fileStat.st_size);
+				void* mapped {_size ? ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr};
+				::close(fd);
+				if (mapped == MAP_FAILED) {
+					throw std::runtime_error{"Cannot map file " + filename};
+				}
+				_data = static_cast<const char*>(mapped);
+			}
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			~MappedFile() {
+				if (_data) {
+					::munmap(const_cast<char*>(_data), _size);
+				}
+			}
+
+			[[nodiscard]]
+			const char* data() const noexcept {
+				return _data;
+			}
+
+			[[nodiscard]]
+			size_t size() const noexcept {
+				return _size;
+			}
+		};
+
+		// Sequential reader over the mapped arrays, checking every access against the end of the file
+		class BinaryReader {
+			const char* _cursor;
+			const char* const _end;
+
+			void _require(const size_t bytes) const {
+				if (static_cast<size_t>(_end - _cursor) < bytes) {
+					throw std::runtime_error{"Truncated binary circuit"};
+				}
+			}
+
+		public:
+			BinaryReader(const char* data, const size_t size) noexcept:
+				_cursor {data},
+				_end {data + size}
+			{}
+
+			template <typename T>
+			void read(T& value) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				_require(sizeof(T));
+				std::memcpy(&value, _cursor, sizeof(T));
+				_cursor += sizeof(T);
+			}
+
+			/**
+			 * @param expectedSize element count the array must have, or SIZE_MAX to accept any
+			 */
+			template <typename T>
+			std::vector<T> read_array(const size_t expectedSize = std::numeric_limits<size_t>::max()) {
+				uint64_t size;
+				read(size);
+				if (expectedSize != std::numeric_limits<size_t>::max() && size != expectedSize) {
+					throw std::runtime_error{"Binary circuit array has an unexpected size"};
+				}
+				if (size > static_cast<size_t>(_end - _cursor) / sizeof(T)) {
+					throw std::runtime_error{"Truncated binary circuit"};
+				}
+
+				const size_t bytes {size * sizeof(T)};
+				std::vector<T> array(size);
+				std::memcpy(array.data(), _cursor, bytes);
+				const size_t padded {(bytes + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT};
+				_require(padded);
+				_cursor += padded;
+				return array;
+			}
+
+			[[nodiscard]]
+			bool at_end() const noexcept {
+				return _cursor == _end;
+			}
+		};
+
+		template <typename T, typename Bound>
+		void check_bounded(const std::vector<T>& values, const Bound bound, const char* what) {
+			for (const T value : values) {
+				bool negative {false};
+				if constexpr (std::is_signed_v<T>) {
+					negative = value < 0;
+				}
+				if (negative || static_cast<uint64_t>(value) >= static_cast<uint64_t>(bound)) {
+					throw std::runtime_error{std::string{"Binary circuit has an out-of-range "} + what};
+				}
+			}
+		}
+	}
+
+	void Circuit::save(const std::string& filename) const {
+		std::ofstream fout {filename, std::ios::binary | std::ios::trunc};
+		if (!fout) {
+			throw std::runtime_error{"Cannot open file " + filename};
+		}
+
+		const BinaryHeader header {
+			BINARY_MAGIC,
+			BINARY_FORMAT_VERSION,
+			BYTE_ORDER_MARK,
+			gateSize, wireSize, inputSize0, inputSize1, outputSize, andGateSize, _labelSlotSize
+		};
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		write_array(fout, gateArrays.types);
+		write_array(fout, gateArrays.in0);
+		write_array(fout, gateArrays.in1);
+		write_array(fout, gateArrays.out);
+		write_array(fout, _andGateOrder);
+		write_array(fout, _andToGlobalIndex);
+		write_array(fout, _outputWireToGateIndex);
+
+		write_array(fout, _xorSourceMatrix._sources);
+		write_array(fout, _xorSourceMatrix._rowBegin);
+		write_array(fout, _xorSourceMatrix._rowLength);
+		write_array(fout, dump_raw_blocks(_xorSourceMatrix._flip));
+
+		write_array(fout, _gcCheckOffsets);
+		write_array(fout, _gcCheckAndOrders);
+		write_array(fout, _gcCheckConnections);
+
+		write_array(fout, _levelGates);
+		write_array(fout, _levelBegin);
+		write_array(fout, _levelAndBegin);
+
+		write_array(fout, _labelSlot);
+
+		if (!fout) {
+			throw std::runtime_error{"Cannot write file " + filename};
+		}
+	}
+
+	Circuit Circuit::Load(const std::string& filename) {
+		const MappedFile file {filename};
+		BinaryReader reader {file.data(), file.size()};
+
+		BinaryHeader header;
+		reader.read(header);
+		if (header.magic != BINARY_MAGIC || header.byteOrder != BYTE_ORDER_MARK) {
+			throw std::runtime_error{filename + " is not a binary circuit of this architecture"};
+		}
+		if (header.version != BINARY_FORMAT_VERSION) {
+			throw std::runtime_error{
+				"Binary circuit format version " + std::to_string(header.version) + " is not supported"
+			};
+		}
+
+		Circuit circuit;
+		circuit.gateSize = header.gateSize;
+		circuit.wireSize = header.wireSize;
+		circuit.inputSize0 = header.inputSize0;
+		circuit.inputSize1 = header.inputSize1;
+		circuit.totalInputSize = header.inputSize0 + header.inputSize1;
+		circuit.outputSize = header.outputSize;
+		circuit.andGateSize = header.andGateSize;
+		circuit._labelSlotSize = header.labelSlotSize;
+		if (circuit.totalInputSize > circuit.wireSize || circuit.outputSize > circuit.wireSize
+			|| circuit.andGateSize > circuit.gateSize || circuit.gateSize >= NO_SOURCE_GATE
+			|| circuit._labelSlotSize > circuit.wireSize) {
+			throw std::runtime_error{"Binary circuit has inconsistent sizes"};
+		}
+
+		auto& gateArrays {circuit.gateArrays};
+		gateArrays.types = reader.read_array<Gate::Type>(circuit.gateSize);
+		gateArrays.in0 = reader.read_array<Wire>(circuit.gateSize);
+		gateArrays.in1 = reader.read_array<Wire>(circuit.gateSize);
+		gateArrays.out = reader.read_array<Wire>(circuit.gateSize);
+		circuit._andGateOrder = reader.read_array<size_t>(circuit.gateSize);
+		circuit._andToGlobalIndex = reader.read_array<size_t>(circuit.andGateSize);
+		circuit._outputWireToGateIndex = reader.read_array<uint32_t>(circuit.wireSize);
+
+		auto& xorSourceMatrix {circuit._xorSourceMatrix};
+		xorSourceMatrix._sources = reader.read_array<Wire>();
+		xorSourceMatrix._rowBegin = reader.read_array<size_t>(circuit.wireSize);
+		xorSourceMatrix._rowLength = reader.read_array<size_t>(circuit.wireSize);
+		const auto flipBlocks {reader.read_array<BitsetBlock>(calc_bitset_block(circuit.wireSize))};
+		xorSourceMatrix._flip = Bitset{flipBlocks.cbegin(), flipBlocks.cend()};
+		xorSourceMatrix._flip.resize(circuit.wireSize);
+
+		circuit._gcCheckOffsets = reader.read_array<size_t>(circuit.independent_size() + 1);
+		circuit._gcCheckAndOrders = reader.read_array<uint32_t>(circuit._gcCheckOffsets.back());
+		circuit._gcCheckConnections = reader.read_array<uint8_t>(circuit._gcCheckOffsets.back());
+
+		circuit._levelGates = reader.read_array<size_t>(circuit.gateSize);
+		circuit._levelBegin = reader.read_array<size_t>();
+		if (circuit._levelBegin.empty()) {
+			throw std::runtime_error{"Binary circuit has no level schedule"};
+		}
+		circuit._levelAndBegin = reader.read_array<size_t>(circuit._levelBegin.size() - 1);
+
+		circuit._labelSlot = reader.read_array<uint32_t>(circuit.wireSize);
+		if (!reader.at_end()) {
+			throw std::runtime_error{"Binary circuit has trailing data"};
+		}
+
+		// Everything later used as an index is checked, so a corrupted file cannot cause out-of-bounds reads
+		for (const Gate::Type type : gateArrays.types) {
+			if (type != Gate::Type::AND && type != Gate::Type::XOR && type != Gate::Type::NOT) {
+				throw std::runtime_error{"Binary circuit has an unknown gate type"};
+			}
+		}
+		check_bounded(gateArrays.in0, circuit.wireSize, "gate input");
+		check_bounded(gateArrays.out, circuit.wireSize, "gate output");
+		for (size_t i {0}; i != circuit.gateSize; ++i) {
+			const Wire in1 {gateArrays.in1[i]};
+			if (gateArrays.types[i] != Gate::Type::NOT && (in1 < 0 || static_cast<size_t>(in1) >= circuit.wireSize)) {
+				throw std::runtime_error{"Binary circuit has an out-of-range gate input"};
+			}
+			if (gateArrays.types[i] == Gate::Type::AND && circuit._andGateOrder[i] >= circuit.andGateSize) {
+				throw std::runtime_error{"Binary circuit has an out-of-range AND order"};
+			}
+		}
+		check_bounded(circuit._andToGlobalIndex, circuit.gateSize, "AND gate index");
+		// The AND order must be a bijection between the AND gates and [0, andGateSize)
+		for (size_t i {0}; i != circuit.gateSize; ++i) {
+			if (gateArrays.types[i] == Gate::Type::AND && circuit._andToGlobalIndex[circuit._andGateOrder[i]] != i) {
+				throw std::runtime_error{"Binary circuit has an inconsistent AND order"};
+			}
+		}
+		for (size_t andOrder {0}; andOrder != circuit.andGateSize; ++andOrder) {
+			const size_t gateIndex {circuit._andToGlobalIndex[andOrder]};
+			if (gateArrays.types[gateIndex] != Gate::Type::AND || circuit._andGateOrder[gateIndex] != andOrder) {
+				throw std::runtime_error{"Binary circuit has an inconsistent AND order"};
+			}
+		}
+		for (const uint32_t gateIndex : circuit._outputWireToGateIndex) {
+			if (gateIndex != NO_SOURCE_GATE && gateIndex >= circuit.gateSize) {
+				throw std::runtime_error{"Binary circuit has an out-of-range source gate"};
+			}
+		}
+		check_bounded(xorSourceMatrix._sources, circuit.wireSize, "XOR source");
+		for (size_t w {0}; w != circuit.wireSize; ++w) {
+			if (xorSourceMatrix._rowBegin[w] > xorSourceMatrix._sources.size()
+				|| xorSourceMatrix._rowLength[w] > xorSourceMatrix._sources.size() - xorSourceMatrix._rowBegin[w]) {
+				throw std::runtime_error{"Binary circuit has an out-of-range XOR source row"};
+			}
+		}
+		if (!std::is_sorted(circuit._gcCheckOffsets.cbegin(), circuit._gcCheckOffsets.cend())
+			|| circuit._gcCheckOffsets.front() != 0) {
+			throw std::runtime_error{"Binary circuit has unsorted GC-check offsets"};
+		}
+		check_bounded(circuit._gcCheckAndOrders, circuit.andGateSize, "GC-check AND order");
+		check_bounded(circuit._levelGates, circuit.gateSize, "scheduled gate");
+		if (!std::is_sorted(circuit._levelBegin.cbegin(), circuit._levelBegin.cend())
+			|| circuit._levelBegin.front() != 0 || circuit._levelBegin.back() != circuit.gateSize) {
+			throw std::runtime_error{"Binary circuit has an invalid level schedule"};
+		}
+		for (size_t l {0}; l != circuit._levelAndBegin.size(); ++l) {
+			if (circuit._levelAndBegin[l] < circuit._levelBegin[l] || circuit._levelAndBegin[l] > circuit._levelBegin[l + 1]) {
+				throw std::runtime_error{"Binary circuit has an invalid level schedule"};
+			}
+		}
+		// Every gate is scheduled exactly once, linear gates in the linear slice and AND gates in the AND slice
+		std::vector<bool> scheduled(circuit.gateSize, false);
+		for (const size_t gateIndex : circuit._levelGates) {
+			if (scheduled[gateIndex]) {
+				throw std::runtime_error{"Binary circuit schedules a gate twice"};
+			}
+			scheduled[gateIndex] = true;
+		}
+		for (size_t l {0}; l != circuit._levelAndBegin.size(); ++l) {
+			for (size_t i {circuit._levelBegin[l]}; i != circuit._levelBegin[l + 1]; ++i) {
+				const bool isAnd {gateArrays.types[circuit._levelGates[i]] == Gate::Type::AND};
+				if (isAnd != (i >= circuit._levelAndBegin[l])) {
+					throw std::runtime_error{"Binary circuit has a gate in the wrong level slice"};
+				}
+			}
+		}
+		check_bounded(circuit._labelSlot, circuit._labelSlotSize, "label slot");
+
+		circuit.gates.reserve(circuit.gateSize);
+		for (size_t i {0}; i != circuit.gateSize; ++i) {
+			if (gateArrays.types[i] == Gate::Type::NOT) {
+				circuit.gates.emplace_back(gateArrays.in0[i], gateArrays.out[i], i);
+			} else {
+				const char typeInitLetter {gateArrays.types[i] == Gate::Type::AND ? 'A' : 'X'};
+				circuit.gates.emplace_back(typeInitLetter, gateArrays.in0[i], gateArrays.in1[i], gateArrays.out[i], i);
+			}
+		}
+		return circuit;
+	}
+}
@@ -0,0 +1,23 @@
+#include "ATLab/cot_backend.hpp"
+
+#ifdef BCOT_BACKEND_FERRET
+#include "ATLab/ferret_cot.hpp"
+#endif // BCOT_BACKEND_FERRET
+
+namespace ATLab::BlockCorrelatedOT {
+    std::unique_ptr<COTSenderBackend> make_COT_sender_backend(NetIO& io) {
+#ifdef BCOT_BACKEND_FERRET
+        return std::make_unique<FerretSender>(io);
+#else
+        return std::make_unique<IKNPSender>(io);
+#endif // BCOT_BACKEND_FERRET
+    }
+
+    std::unique_ptr<COTReceiverBackend> make_COT_receiver_backend(NetIO& io) {
+#ifdef BCOT_BACKEND_FERRET
+        return std::make_unique<FerretReceiver>(io);
+#else
+        return std::make_unique<IKNPReceiver>(io);
+#endif // BCOT_BACKEND_FERRET
+    }
+}
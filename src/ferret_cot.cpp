@@ -0,0 +1,341 @@
+#include "ATLab/ferret_cot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <emp-tool/utils/f2k.h>
+#include <emp-tool/utils/hash.h>
+#include <emp-tool/utils/prg.h>
+
+#include "ATLab/fixed_key_aes.hpp"
+#include "ATLab/params.hpp"
+
+namespace {
+    using namespace ATLab;
+
+    constexpr size_t LPN_ROW_WEIGHT {10};
+
+    // Length-doubling PRG of the GGM tree, from the fixed-key permutation
+    void expand_GGM_node(const emp::block seed, emp::block& left, emp::block& right) noexcept {
+        const FixedKeyAES& pi {FixedKeyAES::Get_instance()};
+        const emp::block seed1 {_mm_xor_si128(seed, _mm_set_epi64x(0, 1))};
+        left = _mm_xor_si128(pi.encrypt(seed), seed);
+        right = _mm_xor_si128(pi.encrypt(seed1), seed1);
+    }
+
+    emp::block level_tweak(const uint64_t round, const size_t baseIndex) noexcept {
+        return _mm_set_epi64x(static_cast<int64_t>(round), static_cast<int64_t>(baseIndex));
+    }
+
+    /**
+     * Σ χ_i · leaves[i] in GF(2^128) over the t * leafSize leaves, with the χ_i expanded from `seed` tree by tree.
+     * `fn(tree, chi)` is called with the χ of every tree.
+     */
+    template <class Func>
+    emp::block weighted_leaf_sum(
+        const emp::block seed,
+        const emp::block* leaves,
+        const size_t t,
+        const size_t leafSize,
+        Func&& fn
+    ) {
+        emp::PRG prg {&seed};
+        std::vector<emp::block> chi(leafSize);
+        emp::block sum {zero_block()};
+        for (size_t tree {0}; tree != t; ++tree) {
+            prg.random_block(chi.data(), static_cast<int>(leafSize));
+            emp::block treeSum;
+            emp::vector_inn_prdt_sum_red(&treeSum, chi.data(), leaves + tree * leafSize, static_cast<int>(leafSize));
+            xor_to(sum, treeSum);
+            fn(tree, chi.data());
+        }
+        return sum;
+    }
+
+    // Σ blocks[j] · X^j in GF(2^128) over the CHECK_SIZE blocks of the consistency check
+    emp::block pack_check_blocks(const emp::block* blocks) {
+        static_assert(BlockCorrelatedOT::FerretParam::CHECK_SIZE == 128);
+        std::array<emp::block, 128> data;
+        std::copy_n(blocks, data.size(), data.begin());
+        emp::GaloisFieldPacking packing;
+        emp::block packed;
+        packing.packing(&packed, data.data());
+        return packed;
+    }
+
+    /**
+     * Calls `fn(row, indices)` for every row of the public LPN matrix, in order.
+     * `indices` holds LPN_ROW_WEIGHT uniform columns in [0, k). The matrix is expanded from a fixed
+     * public seed, so neither party chooses it.
+     */
+    template <class Func>
+    void for_each_LPN_row(const size_t n, const size_t k, Func&& fn) {
+        constexpr size_t ROWS_PER_CHUNK {1024};
+        const emp::block seed {_mm_set_epi64x(0x41544c6162204665, 0x72726574204c504e)}; // "ATLab Ferret LPN"
+        emp::PRG prg {&seed};
+        std::array<uint32_t, ROWS_PER_CHUNK * LPN_ROW_WEIGHT> indices;
+        // Multiply-shift range reduction; products whose low half is below `threshold` would be biased and are resampled
+        const uint32_t range {static_cast<uint32_t>(k)};
+        const uint32_t threshold {static_cast<uint32_t>(-range) % range};
+        for (size_t chunkBegin {0}; chunkBegin < n; chunkBegin += ROWS_PER_CHUNK) {
+            const size_t rows {std::min(ROWS_PER_CHUNK, n - chunkBegin)};
+            prg.random_data(indices.data(), static_cast<int>(rows * LPN_ROW_WEIGHT * sizeof(uint32_t)));
+            for (size_t i {0}; i != rows * LPN_ROW_WEIGHT; ++i) {
+                uint64_t product {uint64_t{indices[i]} * range};
+                while (static_cast<uint32_t>(product) < threshold) {
+                    uint32_t fresh;
+                    prg.random_data(&fresh, sizeof(fresh));
+                    product = uint64_t{fresh} * range;
+                }
+                indices[i] = static_cast<uint32_t>(product >> 32);
+            }
+            for (size_t i {0}; i != rows; ++i) {
+                fn(chunkBegin + i, indices.data() + i * LPN_ROW_WEIGHT);
+            }
+        }
+    }
+}
+
+namespace ATLab::BlockCorrelatedOT {
+
+    void FerretParam::check() const {
+        if (!k || k > std::numeric_limits<uint32_t>::max() || !t || !treeHeight || treeHeight >= 32 || n != (t << treeHeight) || reserve_size() >= n) {
+            std::ostringstream sout;
+            sout << "Invalid Ferret parameters (n = " << n << ", k = " << k << ", t = " << t
+                << ", treeHeight = " << treeHeight << ").\n";
+            throw std::invalid_argument{sout.str()};
+        }
+    }
+
+    FerretSender::FerretSender(NetIO& io, FerretParam param):
+        _param {param},
+        _base {io},
+        _io {io}
+    {
+        _param.check();
+    }
+
+    void FerretSender::_extend() {
+        const size_t
+            reserveSize {_param.reserve_size()},
+            treeHeight {_param.treeHeight},
+            leafSize {size_t{1} << treeHeight};
+        const emp::block delta {this->delta()};
+
+        std::vector<emp::block> base(reserveSize);
+        if (_keys.empty()) {
+            _base.send_cot(base.data(), reserveSize);
+        } else {
+            std::copy(_keys.end() - static_cast<std::ptrdiff_t>(reserveSize), _keys.end(), base.begin());
+        }
+
+        // MPFSS: the receiver learns every leaf except the noisy one, and leaf ^ Δ there
+        std::vector<emp::block> output(_param.n);
+        std::vector<emp::block> messages;
+        messages.reserve(_param.t * (2 * treeHeight + 1));
+        for (size_t tree {0}; tree != _param.t; ++tree) {
+            emp::block* nodes {output.data() + tree * leafSize};
+            THE_GLOBAL_PRNG.random_block(nodes, 1);
+
+            for (size_t level {1}; level <= treeHeight; ++level) {
+                const size_t parentWidth {size_t{1} << (level - 1)};
+                for (size_t i {parentWidth}; i-- > 0;) {
+                    expand_GGM_node(nodes[i], nodes[2 * i], nodes[2 * i + 1]);
+                }
+
+                emp::block evenSum {zero_block()}, oddSum {zero_block()};
+                for (size_t i {0}; i != 2 * parentWidth; i += 2) {
+                    xor_to(evenSum, nodes[i]);
+                    xor_to(oddSum, nodes[i + 1]);
+                }
+
+                const size_t baseIndex {_param.k + tree * treeHeight + level - 1};
+                const emp::block tweak {level_tweak(_round, baseIndex)};
+                messages.push_back(evenSum ^ tccr_hash(base[baseIndex], tweak));
+                messages.push_back(oddSum ^ tccr_hash(base[baseIndex] ^ delta, tweak));
+            }
+
+            emp::block leafSum {delta};
+            for (size_t i {0}; i != leafSize; ++i) {
+                xor_to(leafSum, nodes[i]);
+            }
+            messages.push_back(leafSum);
+        }
+        _io.send_data(messages.data(), messages.size() * sizeof(emp::block));
+
+        // Consistency check: V = Σ χ_i v_i ⊕ Y ⊕ x'·Δ, compared by hash so that a wrong x' does not reveal Δ
+        std::array<emp::block, 2> challenge; // χ seed, x'
+        _io.recv_data(challenge.data(), challenge.size() * sizeof(emp::block));
+        emp::block checkValue {weighted_leaf_sum(challenge[0], output.data(), _param.t, leafSize, [](size_t, const emp::block*) {})};
+        xor_to(checkValue, pack_check_blocks(base.data() + _param.k + _param.t * treeHeight));
+        xor_to(checkValue, gf_mul_block(challenge[1], delta));
+        const emp::block checkHash {emp::Hash::hash_for_block(&checkValue, sizeof(checkValue))};
+        _io.send_data(&checkHash, sizeof(checkHash));
+
+        // Primal LPN
+        for_each_LPN_row(_param.n, _param.k, [&output, &base](const size_t row, const uint32_t* indices) {
+            for (size_t i {0}; i != LPN_ROW_WEIGHT; ++i) {
+                xor_to(output[row], base[indices[i]]);
+            }
+        });
+
+        _keys = std::move(output);
+        _cursor = 0;
+        ++_round;
+    }
+
+    void FerretSender::send_cot(emp::block* keys, size_t len) {
+        while (len) {
+            if (_keys.empty() || _cursor == _param.usable_size()) {
+                _extend();
+            }
+            const size_t count {std::min(len, _param.usable_size() - _cursor)};
+            std::copy_n(_keys.begin() + static_cast<std::ptrdiff_t>(_cursor), count, keys);
+            _cursor += count;
+            keys += count;
+            len -= count;
+        }
+    }
+
+    FerretReceiver::FerretReceiver(NetIO& io, FerretParam param):
+        _param {param},
+        _base {io},
+        _io {io}
+    {
+        _param.check();
+    }
+
+    void FerretReceiver::_extend() {
+        const size_t
+            reserveSize {_param.reserve_size()},
+            treeHeight {_param.treeHeight},
+            leafSize {size_t{1} << treeHeight};
+
+        std::vector<emp::block> baseMacs(reserveSize);
+        Bitset baseChoices(reserveSize);
+        if (_macs.empty()) {
+            std::unique_ptr<bool[]> choices {new bool[reserveSize]};
+            _base.recv_cot(baseMacs.data(), choices.get(), reserveSize);
+            for (size_t i {0}; i != reserveSize; ++i) {
+                baseChoices.set(i, choices[i]);
+            }
+        } else {
+            const size_t offset {_param.usable_size()};
+            std::copy(_macs.end() - static_cast<std::ptrdiff_t>(reserveSize), _macs.end(), baseMacs.begin());
+            for (size_t i {0}; i != reserveSize; ++i) {
+                baseChoices.set(i, _choices[offset + i]);
+            }
+        }
+
+        std::vector<emp::block> messages(_param.t * (2 * treeHeight + 1));
+        _io.recv_data(messages.data(), messages.size() * sizeof(emp::block));
+
+        // MPFSS. The noisy leaf α of each tree is given by the complement of the base choices.
+        std::vector<emp::block> output(_param.n, zero_block());
+        Bitset outputChoices(_param.n);
+        std::vector<size_t> noisyLeaves(_param.t);
+        for (size_t tree {0}; tree != _param.t; ++tree) {
+            emp::block* nodes {output.data() + tree * leafSize};
+            const emp::block* treeMessages {messages.data() + tree * (2 * treeHeight + 1)};
+            size_t path {0}; // the unknown node on the current level
+
+            for (size_t level {1}; level <= treeHeight; ++level) {
+                const size_t parentWidth {size_t{1} << (level - 1)};
+                if (level == 1) {
+                    nodes[0] = nodes[1] = zero_block();
+                } else {
+                    for (size_t i {parentWidth}; i-- > 0;) {
+                        if (i == path) {
+                            nodes[2 * i] = nodes[2 * i + 1] = zero_block();
+                        } else {
+                            expand_GGM_node(nodes[i], nodes[2 * i], nodes[2 * i + 1]);
+                        }
+                    }
+                }
+
+                const size_t baseIndex {_param.k + tree * treeHeight + level - 1};
+                const bool choice {baseChoices[baseIndex]};
+                const size_t sibling {2 * path + choice};
+                emp::block siblingValue {treeMessages[2 * (level - 1) + choice]};
+                xor_to(siblingValue, tccr_hash(baseMacs[baseIndex], level_tweak(_round, baseIndex)));
+                for (size_t i {choice}; i < 2 * parentWidth; i += 2) {
+                    if (i != sibling) {
+                        xor_to(siblingValue, nodes[i]);
+                    }
+                }
+                nodes[sibling] = siblingValue;
+                path = 2 * path + !choice;
+            }
+
+            emp::block leafSum {treeMessages[2 * treeHeight]};
+            for (size_t i {0}; i != leafSize; ++i) {
+                xor_to(leafSum, nodes[i]);
+            }
+            nodes[path] = leafSum;
+            outputChoices.set(tree * leafSize + path);
+            noisyLeaves[tree] = path;
+        }
+
+        // Consistency check: W = Σ χ_i w_i ⊕ Z must equal the sender's V, with x' = Σ χ_α ⊕ x*
+        const size_t checkBegin {_param.k + _param.t * treeHeight};
+        emp::block seed;
+        THE_GLOBAL_PRNG.random_block(&seed, 1);
+        emp::block chiAlphaSum {zero_block()};
+        emp::block checkValue {weighted_leaf_sum(seed, output.data(), _param.t, leafSize,
+            [&chiAlphaSum, &noisyLeaves](const size_t tree, const emp::block* chi) {
+                xor_to(chiAlphaSum, chi[noisyLeaves[tree]]);
+            }
+        )};
+        xor_to(checkValue, pack_check_blocks(baseMacs.data() + checkBegin));
+        __uint128_t checkChoices {0};
+        for (size_t j {0}; j != FerretParam::CHECK_SIZE; ++j) {
+            checkChoices |= static_cast<__uint128_t>(baseChoices[checkBegin + j]) << j;
+        }
+        const std::array<emp::block, 2> challenge {seed, chiAlphaSum ^ as_block(checkChoices)};
+        _io.send_data(challenge.data(), challenge.size() * sizeof(emp::block));
+        emp::block senderHash;
+        _io.recv_data(&senderHash, sizeof(senderHash));
+        if (as_uint128(senderHash) != as_uint128(emp::Hash::hash_for_block(&checkValue, sizeof(checkValue)))) {
+            throw std::runtime_error{ERR_MALICIOUS};
+        }
+
+        // Primal LPN
+        for_each_LPN_row(_param.n, _param.k,
+            [&output, &outputChoices, &baseMacs, &baseChoices](const size_t row, const uint32_t* indices) {
+                bool choice {false};
+                for (size_t i {0}; i != LPN_ROW_WEIGHT; ++i) {
+                    xor_to(output[row], baseMacs[indices[i]]);
+                    choice ^= baseChoices[indices[i]];
+                }
+                if (choice) {
+                    outputChoices.flip(row);
+                }
+            }
+        );
+
+        _macs = std::move(output);
+        _choices = std::move(outputChoices);
+        _cursor = 0;
+        ++_round;
+    }
+
+    void FerretReceiver::recv_cot(emp::block* macs, bool* choices, size_t len) {
+        while (len) {
+            if (_macs.empty() || _cursor == _param.usable_size()) {
+                _extend();
+            }
+            const size_t count {std::min(len, _param.usable_size() - _cursor)};
+            std::copy_n(_macs.begin() + static_cast<std::ptrdiff_t>(_cursor), count, macs);
+            for (size_t i {0}; i != count; ++i) {
+                choices[i] = _choices[_cursor + i];
+            }
+            _cursor += count;
+            macs += count;
+            choices += count;
+            len -= count;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include "ATLab/fixed_key_aes.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ATLab_HAS_VAES_PATH
+#endif
+
+namespace ATLab {
+    namespace {
+        // Independent blocks kept in flight by the AES-NI path; aesenc has a latency of about 4 cycles
+        constexpr size_t AESNI_WIDTH {8};
+
+        template <size_t N>
+        void encrypt_interleaved(const emp::block* roundKeys, const size_t rounds, emp::block* blocks) noexcept {
+            std::array<emp::block, N> state;
+            for (size_t i {0}; i != N; ++i) {
+                state[i] = _mm_xor_si128(blocks[i], roundKeys[0]);
+            }
+            for (size_t round {1}; round != rounds; ++round) {
+                for (size_t i {0}; i != N; ++i) {
+                    state[i] = _mm_aesenc_si128(state[i], roundKeys[round]);
+                }
+            }
+            for (size_t i {0}; i != N; ++i) {
+                blocks[i] = _mm_aesenclast_si128(state[i], roundKeys[rounds]);
+            }
+        }
+
+        void encrypt_batch_AESNI(const emp::block* roundKeys, const size_t rounds, emp::block* blocks, size_t n) noexcept {
+            for (; n >= AESNI_WIDTH; n -= AESNI_WIDTH, blocks += AESNI_WIDTH) {
+                encrypt_interleaved<AESNI_WIDTH>(roundKeys, rounds, blocks);
+            }
+            for (; n >= 2; n -= 2, blocks += 2) {
+                encrypt_interleaved<2>(roundKeys, rounds, blocks);
+            }
+            if (n) {
+                encrypt_interleaved<1>(roundKeys, rounds, blocks);
+            }
+        }
+
+#ifdef ATLab_HAS_VAES_PATH
+        template <size_t LANES>
+        __attribute__((target("avx512f,vaes")))
+        void encrypt_interleaved_VAES(const emp::block* roundKeys, const size_t rounds, emp::block* blocks) noexcept {
+            std::array<__m512i, LANES> state;
+            const __m512i key0 {_mm512_broadcast_i32x4(roundKeys[0])};
+            for (size_t i {0}; i != LANES; ++i) {
+                state[i] = _mm512_xor_si512(_mm512_loadu_si512(blocks + 4 * i), key0);
+            }
+            for (size_t round {1}; round != rounds; ++round) {
+                const __m512i key {_mm512_broadcast_i32x4(roundKeys[round])};
+                for (size_t i {0}; i != LANES; ++i) {
+                    state[i] = _mm512_aesenc_epi128(state[i], key);
+                }
+            }
+            const __m512i keyLast {_mm512_broadcast_i32x4(roundKeys[rounds])};
+            for (size_t i {0}; i != LANES; ++i) {
+                _mm512_storeu_si512(blocks + 4 * i, _mm512_aesenclast_epi128(state[i], keyLast));
+            }
+        }
+
+        // 4 blocks per zmm register, up to 4 registers in flight
+        __attribute__((target("avx512f,vaes")))
+        void encrypt_batch_VAES(const emp::block* roundKeys, const size_t rounds, emp::block* blocks, size_t n) noexcept {
+            for (; n >= 16; n -= 16, blocks += 16) {
+                encrypt_interleaved_VAES<4>(roundKeys, rounds, blocks);
+            }
+            if (n >= 8) {
+                encrypt_interleaved_VAES<2>(roundKeys, rounds, blocks);
+                n -= 8;
+                blocks += 8;
+            }
+            if (n >= 4) {
+                encrypt_interleaved_VAES<1>(roundKeys, rounds, blocks);
+                n -= 4;
+                blocks += 4;
+            }
+            encrypt_batch_AESNI(roundKeys, rounds, blocks, n);
+        }
+
+        bool cpu_has_VAES() noexcept {
+            static const bool supported {__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("vaes")};
+            return supported;
+        }
+#endif // ATLab_HAS_VAES_PATH
+    }
+
+    void FixedKeyAES::encrypt_batch(emp::block* blocks, const size_t n) const noexcept {
+#ifdef ATLab_HAS_VAES_PATH
+        if (cpu_has_VAES()) {
+            encrypt_batch_VAES(_roundKeys.data(), ROUNDS, blocks, n);
+            return;
+        }
+#endif // ATLab_HAS_VAES_PATH
+        encrypt_batch_AESNI(_roundKeys.data(), ROUNDS, blocks, n);
+    }
+
+    void tccr_hash_batch(const emp::block* x, const emp::block* tweaks, emp::block* out, size_t n) noexcept {
+        const FixedKeyAES& pi {FixedKeyAES::Get_instance()};
+        std::array<emp::block, TCCR_HASH_BATCH_SIZE> u;
+        while (n) {
+            const size_t count {std::min(n, TCCR_HASH_BATCH_SIZE)};
+            std::copy_n(x, count, u.data());
+            pi.encrypt_batch(u.data(), count);
+            for (size_t i {0}; i != count; ++i) {
+                out[i] = _mm_xor_si128(u[i], tweaks[i]);
+            }
+            pi.encrypt_batch(out, count);
+            for (size_t i {0}; i != count; ++i) {
+                out[i] = _mm_xor_si128(out[i], sigma(u[i]));
+            }
+            x += count;
+            tweaks += count;
+            out += count;
+            n -= count;
+        }
+    }
+}
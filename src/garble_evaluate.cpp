@@ -1,104 +1,511 @@
 #include <ATLab/garble_evaluate.hpp>
+#include <ATLab/params.hpp>
+#include <ATLab/thread_pool.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
 
 namespace ATLab {
+    namespace {
+        // Feeds one chunk to `hash`, in the order of its bytes on the wire
+        void hash_garbled_chunk(
+            emp::Hash& hash,
+            const std::array<emp::block, 2>* garbledTables,
+            const BitsetBlock* wireMaskShift,
+            const size_t chunkSize
+        ) {
+            hash.put(garbledTables, static_cast<int>(chunkSize * 2 * sizeof(emp::block)));
+            hash.put(wireMaskShift, static_cast<int>(calc_bitset_block(chunkSize) * sizeof(BitsetBlock)));
+        }
+    }
+
     namespace Garbler {
+        namespace {
+            /**
+             * Garbles the circuit level by level, passing every chunk to `sink(garbledTables, wireMaskShift)`
+             * in schedule order. The chunk buffers are reused once `sink` returns.
+             */
+            template <class ChunkSink>
+            GarbledCircuit garble_chunks(
+                const Circuit& circuit,
+                const PreprocessedData& wireMasks,
+                std::vector<emp::block> label0,
+                const size_t threadCount,
+                ChunkSink&& sink
+            ) {
+                const auto& [masks, maskKeys, beaverTriples, beaverTripleKeys] {wireMasks};
+                const emp::block& globalKey {maskKeys.get_global_key(0)};
+
+                // Initialize input wire labels
+                if (label0.empty()) {
+                    // gen random labels
+                    label0.resize(circuit.label_slot_size());
+                    THE_GLOBAL_PRNG.random_block(label0.data(), circuit.totalInputSize);
+                } else {
+                    // use passed label0
+                    assert(label0.size() == circuit.totalInputSize);
+                    label0.resize(circuit.label_slot_size());
+                }
+
+                // garbled tables of the current chunk, for and gates
+                const size_t windowSize {std::min(GARBLE_CHUNK_SIZE, circuit.andGateSize)};
+                GarbledTableVec garbledTables;
+                garbledTables.reserve(windowSize);
+                Bitset wireMaskShift;
+                wireMaskShift.reserve(windowSize);
+                auto flush_chunk {[&sink, &garbledTables, &wireMaskShift]() {
+                    sink(std::as_const(garbledTables), std::as_const(wireMaskShift));
+                    garbledTables.clear();
+                    wireMaskShift.clear();
+                }};
+
+                const auto& [types, in0s, in1s, outs] {circuit.gateArrays};
+
+                // Garbles `count` AND gates: writes label0 of their output wires and their garbled tables
+                auto garble_AND_batch {[&](const size_t* gateIndices, const size_t count, std::array<emp::block, 2>* tables) {
+                    // per gate: H(label0[in0], 0), H(label1[in0], 0), H(label0[in1], 1), H(label1[in1], 1)
+                    std::array<emp::block, 4 * GARBLE_BATCH_SIZE> hashInputs {}, tweaks {}, hashes;
+                    for (size_t i {0}; i != count; ++i) {
+                        const size_t gateIndex {gateIndices[i]};
+                        const emp::block in0Label0 {label0[circuit.label_slot(in0s[gateIndex])]};
+                        const emp::block in1Label0 {label0[circuit.label_slot(in1s[gateIndex])]};
+                        hashInputs[4 * i] = in0Label0;
+                        hashInputs[4 * i + 1] = _mm_xor_si128(in0Label0, globalKey);
+                        hashInputs[4 * i + 2] = in1Label0;
+                        hashInputs[4 * i + 3] = _mm_xor_si128(in1Label0, globalKey);
+                        tweaks[4 * i] = tweaks[4 * i + 1] = garble_tweak(outs[gateIndex], 0);
+                        tweaks[4 * i + 2] = tweaks[4 * i + 3] = garble_tweak(outs[gateIndex], 1);
+                    }
+                    hash_batch(hashInputs.data(), tweaks.data(), hashes.data(), 4 * count);
+
+                    for (size_t i {0}; i != count; ++i) {
+                        const size_t gateIndex {gateIndices[i]};
+                        const Wire in0 {in0s[gateIndex]}, in1 {in1s[gateIndex]}, out {outs[gateIndex]};
+                        const emp::block* gateHashes {hashes.data() + 4 * i};
+                        const size_t andGateIter {circuit.and_gate_order(gateIndex)};
+                        emp::block tableEntry0 {_mm_xor_si128(
+                            maskKeys.get_local_key(0, in1),
+                            and_all_bits(masks[in1], globalKey)
+                        )};
+                        xor_to(tableEntry0, gateHashes[0]);
+                        xor_to(tableEntry0, gateHashes[1]);
+
+                        emp::block tableEntry1 {hashInputs[4 * i]};
+                        xor_to(tableEntry1, and_all_bits(masks[in0], globalKey));
+                        xor_to(tableEntry1, maskKeys.get_local_key(0, in0));
+                        xor_to(tableEntry1, gateHashes[2]);
+                        xor_to(tableEntry1, gateHashes[3]);
+
+                        tables[i] = {tableEntry0, tableEntry1};
+
+                        emp::block& outLabel {label0[circuit.label_slot(out)]};
+                        outLabel = _mm_xor_si128(gateHashes[0], gateHashes[2]);
+                        xor_to(outLabel, and_all_bits(
+                                   masks[out] ^ beaverTriples[andGateIter],
+                                   globalKey
+                               ));
+                        xor_to(outLabel, maskKeys.get_local_key(0, out));
+                        xor_to(outLabel, beaverTripleKeys.get_local_key(0, andGateIter));
+                    }
+                }};
+
+                // process the circuit level by level; AND gates of a level are garbled in parallel,
+                // in batches of GARBLE_BATCH_SIZE sharing one `hash_batch` call
+                ThreadPool pool {threadCount};
+                for (size_t l {0}; l != circuit.level_size(); ++l) {
+                    const auto [linearGates, andGates] {circuit.level(l)};
+                    for (const size_t gateIndex : linearGates) {
+                        emp::block& outLabel {label0[circuit.label_slot(outs[gateIndex])]};
+                        const emp::block& in0Label {label0[circuit.label_slot(in0s[gateIndex])]};
+                        switch (types[gateIndex]) {
+                        case Gate::Type::NOT: {
+                            // label0 of the output is label1 of the input
+                            outLabel = _mm_xor_si128(in0Label, globalKey);
+                            break;
+                        }
+                        case Gate::Type::XOR: {
+                            outLabel = _mm_xor_si128(in0Label, label0[circuit.label_slot(in1s[gateIndex])]);
+                            break;
+                        }
+                        default: {
+                            throw std::runtime_error{"Unexpected gate type"};
+                        }
+                        }
+                    }
+
+                    // slices never cross a chunk, so tables land in schedule order
+                    for (size_t sliceBegin {0}; sliceBegin != andGates.size();) {
+                        const size_t sliceSize {
+                            std::min(andGates.size() - sliceBegin, GARBLE_CHUNK_SIZE - garbledTables.size())
+                        };
+                        const size_t tableBegin {garbledTables.size()};
+                        garbledTables.resize(tableBegin + sliceSize);
+                        const size_t batchSize {(sliceSize + GARBLE_BATCH_SIZE - 1) / GARBLE_BATCH_SIZE};
+                        pool.parallel_for(0, batchSize, [&](const size_t batch) {
+                            const size_t offset {batch * GARBLE_BATCH_SIZE};
+                            garble_AND_batch(
+                                andGates.data() + sliceBegin + offset,
+                                std::min(GARBLE_BATCH_SIZE, sliceSize - offset),
+                                garbledTables.data() + tableBegin + offset
+                            );
+                        });
+                        for (size_t i {0}; i != sliceSize; ++i) {
+                            wireMaskShift.push_back(get_LSB(
+                                label0[circuit.label_slot(outs[andGates[sliceBegin + i]])]
+                            ));
+                        }
+                        sliceBegin += sliceSize;
+                        if (garbledTables.size() == GARBLE_CHUNK_SIZE) {
+                            flush_chunk();
+                        }
+                    }
+                }
+
+                if (!garbledTables.empty()) {
+                    flush_chunk();
+                }
+
+                return {std::move(label0), globalKey};
+            }
+        }
+
         GarbledCircuit garble(
             ATLab::NetIO& io,
             const Circuit& circuit,
             const PreprocessedData& wireMasks,
-            std::vector<emp::block> label0
+            std::vector<emp::block> label0,
+            const size_t threadCount
         ) {
-            const auto& [masks, maskKeys, beaverTriples, beaverTripleKeys] {wireMasks};
-            const emp::block& globalKey {maskKeys.get_global_key(0)};
-
-            // Initialize input wire labels
-            std::vector<emp::block> label1(circuit.wireSize);
-            if (label0.empty()) {
-                // gen random labels
-                label0.resize(circuit.wireSize);
-                THE_GLOBAL_PRNG.random_block(label0.data(), circuit.totalInputSize);
-            } else {
-                // use passed label0
-                assert(label0.size() == circuit.totalInputSize);
-                label0.resize(circuit.wireSize);
-            }
-            for (size_t i {0}; i != circuit.totalInputSize; ++i) {
-                label1[i] = _mm_xor_si128(label0[i], globalKey);
+            return garble_chunks(circuit, wireMasks, std::move(label0), threadCount, [&io](
+                const GarbledTableVec& garbledTables,
+                const Bitset& wireMaskShift
+            ) {
+                io.send_data(garbledTables.data(), garbledTables.size() * 2 * sizeof(emp::block));
+                send_boost_bitset(io, wireMaskShift);
+                io.flush();
+            });
+        }
+
+        void commit_garbled_tables(
+            ATLab::NetIO& io,
+            const Circuit& circuit,
+            const PreprocessedData& wireMasks,
+            std::vector<emp::block> label0,
+            const size_t threadCount
+        ) {
+            assert(label0.size() == circuit.totalInputSize);
+            emp::Hash hash;
+            garble_chunks(circuit, wireMasks, std::move(label0), threadCount, [&hash](
+                const GarbledTableVec& garbledTables,
+                const Bitset& wireMaskShift
+            ) {
+                hash_garbled_chunk(hash, garbledTables.data(), dump_raw_blocks(wireMaskShift).data(), garbledTables.size());
+            });
+            GarbledTablesDigest digest;
+            hash.digest(digest.data());
+            io.send_data(digest.data(), digest.size());
+        }
+
+        GarbledCircuit gen_input_labels(const Circuit& circuit, const PreprocessedData& wireMasks) {
+            std::vector<emp::block> label0(circuit.totalInputSize);
+            THE_GLOBAL_PRNG.random_block(label0.data(), circuit.totalInputSize);
+            return {std::move(label0), wireMasks.maskKeys.get_global_key(0)};
+        }
+    }
+
+    namespace Evaluator {
+        namespace {
+            /**
+             * Evaluates the circuit level by level; AND gates of a level are evaluated in parallel,
+             * in batches of GARBLE_BATCH_SIZE sharing one `hash_batch` call.
+             * `tables.tables(k)` points to the garbled table of the k-th scheduled AND gate, valid up to the end of
+             * its GARBLE_CHUNK_SIZE chunk, and `tables.wire_mask_shift(k)` returns its bit from that chunk.
+             */
+            template <class TableSource>
+            EvaluateResult evaluate_gates(
+                const Circuit&                  circuit,
+                const PreprocessedData&         wireMasks,
+                TableSource&                    tables,
+                std::vector<emp::block>         labels,
+                Bitset                          maskedValues,
+                const size_t                    threadCount
+            ) {
+                const auto& masks {wireMasks.masks};
+                const auto& beaverTriples {wireMasks.beaverTripleShares};
+
+                maskedValues.resize(circuit.wireSize);
+                labels.resize(circuit.label_slot_size());
+                const auto& [types, in0s, in1s, outs] {circuit.gateArrays};
+
+                // Writes the labels of the output wires of `count` AND gates.
+                // The masked values are set afterward, as Bitset writes race.
+                auto evaluate_AND_batch {[&](
+                    const size_t* gateIndices,
+                    const size_t count,
+                    const std::array<emp::block, 2>* garbledTables
+                ) {
+                    std::array<emp::block, 2 * GARBLE_BATCH_SIZE> hashInputs {}, tweaks {}, hashes;
+                    for (size_t i {0}; i != count; ++i) {
+                        const size_t gateIndex {gateIndices[i]};
+                        hashInputs[2 * i] = labels[circuit.label_slot(in0s[gateIndex])];
+                        hashInputs[2 * i + 1] = labels[circuit.label_slot(in1s[gateIndex])];
+                        tweaks[2 * i] = garble_tweak(outs[gateIndex], 0);
+                        tweaks[2 * i + 1] = garble_tweak(outs[gateIndex], 1);
+                    }
+                    hash_batch(hashInputs.data(), tweaks.data(), hashes.data(), 2 * count);
+
+                    for (size_t i {0}; i != count; ++i) {
+                        const size_t gateIndex {gateIndices[i]};
+                        const Wire in0 {in0s[gateIndex]}, in1 {in1s[gateIndex]}, out {outs[gateIndex]};
+                        const size_t andGateIter {circuit.and_gate_order(gateIndex)};
+                        emp::block g0 {_mm_xor_si128(
+                            garbledTables[i][0],
+                            masks.get_mac(0, in1)
+                        )};
+                        emp::block g1 {_mm_xor_si128(
+                            garbledTables[i][1],
+                            masks.get_mac(0, in0)
+                        )};
+                        xor_to(g1, hashInputs[2 * i]);
+
+                        emp::block label {_mm_xor_si128(hashes[2 * i], hashes[2 * i + 1])};
+                        xor_to(label, masks.get_mac(0, out));
+                        xor_to(label, beaverTriples.get_mac(0, andGateIter));
+                        xor_to(label, and_all_bits(maskedValues[in0], g0));
+                        xor_to(label, and_all_bits(maskedValues[in1], g1));
+                        labels[circuit.label_slot(out)] = label;
+                    }
+                }};
+
+                ThreadPool pool {threadCount};
+                size_t tableIter {0};
+                for (size_t l {0}; l != circuit.level_size(); ++l) {
+                    const auto [linearGates, andGates] {circuit.level(l)};
+                    for (const size_t gateIndex : linearGates) {
+                        const Wire in0 {in0s[gateIndex]}, out {outs[gateIndex]};
+                        switch (types[gateIndex]) {
+                        case Gate::Type::NOT: {
+                            maskedValues[out] = not maskedValues[in0];
+                            labels[circuit.label_slot(out)] = labels[circuit.label_slot(in0)];
+                            break;
+                        }
+                        case Gate::Type::XOR: {
+                            const Wire in1 {in1s[gateIndex]};
+                            maskedValues[out] = maskedValues[in0] ^ maskedValues[in1];
+                            labels[circuit.label_slot(out)] = _mm_xor_si128(
+                                labels[circuit.label_slot(in0)],
+                                labels[circuit.label_slot(in1)]
+                            );
+                            break;
+                        }
+                        default: {
+                            throw std::runtime_error{"Unexpected gate type"};
+                        }
+                        }
+                    }
+
+                    for (size_t sliceBegin {0}; sliceBegin != andGates.size();) {
+                        const size_t sliceSize {std::min(
+                            andGates.size() - sliceBegin,
+                            GARBLE_CHUNK_SIZE - tableIter % GARBLE_CHUNK_SIZE
+                        )};
+                        const std::array<emp::block, 2>* garbledTables {tables.tables(tableIter)};
+                        const size_t batchSize {(sliceSize + GARBLE_BATCH_SIZE - 1) / GARBLE_BATCH_SIZE};
+                        pool.parallel_for(0, batchSize, [&](const size_t batch) {
+                            const size_t offset {batch * GARBLE_BATCH_SIZE};
+                            evaluate_AND_batch(
+                                andGates.data() + sliceBegin + offset,
+                                std::min(GARBLE_BATCH_SIZE, sliceSize - offset),
+                                garbledTables + offset
+                            );
+                        });
+                        for (size_t i {0}; i != sliceSize; ++i) {
+                            const Wire out {outs[andGates[sliceBegin + i]]};
+                            maskedValues[out] = get_LSB(labels[circuit.label_slot(out)]) ^ tables.wire_mask_shift(tableIter + i);
+                        }
+                        sliceBegin += sliceSize;
+                        tableIter += sliceSize;
+                    }
+                }
+                return {std::move(maskedValues), std::move(labels)};
             }
 
-            // garbled tables, for and gates
-            GarbledTableVec garbledTables;
-            garbledTables.reserve(circuit.andGateSize);
-            Bitset wireMaskShift;
-            wireMaskShift.reserve(circuit.andGateSize);
-
-            // process output wires gate by gate
-            for (size_t gateIter {0}, andGateIter {0}; gateIter != circuit.gateSize; ++gateIter) {
-                switch (const auto& gate {circuit.gates[gateIter]}; gate.type) {
-                case Gate::Type::NOT: {
-                    label0[gate.out] = label1[gate.in0];
-                    label1[gate.out] = label0[gate.in0];
-                    break;
+            // Tables already received in full by `garble`
+            class ReceivedTableSource {
+                const ReceivedGarbledCircuit& _garbledCircuit;
+            public:
+                explicit ReceivedTableSource(const ReceivedGarbledCircuit& garbledCircuit):
+                    _garbledCircuit {garbledCircuit}
+                {}
+
+                const std::array<emp::block, 2>* tables(const size_t k) const noexcept {
+                    return _garbledCircuit.garbledTables.data() + k;
                 }
-                case Gate::Type::AND: {
-                    emp::block tableEntry0 {_mm_xor_si128(
-                        maskKeys.get_local_key(0, gate.in1),
-                        and_all_bits(masks[gate.in1], globalKey)
-                    )};
-                    xor_to(tableEntry0, hash(label0[gate.in0], gate.out, 0));
-                    xor_to(tableEntry0, hash(label1[gate.in0], gate.out, 0));
-
-                    emp::block tableEntry1 {label0[gate.in0]};
-                    xor_to(tableEntry1, and_all_bits(masks[gate.in0], globalKey));
-                    xor_to(tableEntry1, maskKeys.get_local_key(0, gate.in0));
-                    xor_to(tableEntry1, hash(label0[gate.in1], gate.out, 1));
-                    xor_to(tableEntry1, hash(label1[gate.in1], gate.out, 1));
-
-                    garbledTables.push_back({tableEntry0, tableEntry1});
-
-                    label0[gate.out] = _mm_xor_si128(
-                        hash(label0[gate.in0], gate.out, 0),
-                        hash(label0[gate.in1], gate.out, 1)
-                    );
-                    xor_to(label0[gate.out], and_all_bits(
-                               masks[gate.out] ^ beaverTriples[andGateIter],
-                               globalKey
-                           ));
-                    xor_to(label0[gate.out], maskKeys.get_local_key(0, gate.out));
-                    xor_to(label0[gate.out], beaverTripleKeys.get_local_key(0, andGateIter));
-
-                    label1[gate.out] = _mm_xor_si128(label0[gate.out], globalKey);
-                    wireMaskShift.push_back(get_LSB(label0[gate.out]));
-
-                    ++andGateIter;
-                    break;
+
+                bool wire_mask_shift(const size_t k) const {
+                    return _garbledCircuit.wireMaskShift[k];
                 }
-                case Gate::Type::XOR: {
-                    label0[gate.out] = _mm_xor_si128(label0[gate.in0], label0[gate.in1]);
-                    label1[gate.out] = _mm_xor_si128(label0[gate.out], globalKey);
-                    break;
+            };
+
+            /**
+             * Receives garbled-table chunks on a background thread into a ring of GARBLE_RECV_WINDOW slots.
+             * Chunks must be consumed in order; a slot is reused once evaluation moves past its chunk.
+             * The NetIO must not be used by anyone else while the receiver is alive, and is shut down
+             * if the receiver is destroyed before all chunks arrived.
+             */
+            class GarbledChunkReceiver {
+                struct Chunk {
+                    GarbledTableVec garbledTables;
+                    std::vector<BitsetBlock> wireMaskShift;
+                };
+
+                NetIO& _io;
+                const size_t _andGateSize;
+                std::vector<Chunk> _slots;
+                size_t _received {0}, _released {0}; // numbers of chunks
+                bool _stopped {false};
+                std::exception_ptr _error;
+                std::mutex _mutex;
+                std::condition_variable _cv;
+                std::thread _thread;
+
+                const Chunk* _current {nullptr};
+                size_t _currentIndex {0};
+
+                std::optional<emp::Hash> _hash; // of the received chunks, if asked for
+
+                void _receive_all() {
+                    try {
+                        for (size_t chunkIndex {0}; chunkIndex * GARBLE_CHUNK_SIZE < _andGateSize; ++chunkIndex) {
+                            {
+                                std::unique_lock lock {_mutex};
+                                _cv.wait(lock, [this, chunkIndex]() {
+                                    return _stopped || chunkIndex - _released < _slots.size();
+                                });
+                                if (_stopped) {
+                                    return;
+                                }
+                            }
+                            const size_t chunkBegin {chunkIndex * GARBLE_CHUNK_SIZE};
+                            const size_t chunkSize {std::min(GARBLE_CHUNK_SIZE, _andGateSize - chunkBegin)};
+                            Chunk& chunk {_slots[chunkIndex % _slots.size()]};
+                            _io.recv_data(chunk.garbledTables.data(), chunkSize * 2 * sizeof(emp::block));
+                            _io.recv_data(chunk.wireMaskShift.data(), calc_bitset_block(chunkSize) * sizeof(BitsetBlock));
+                            if (_hash) {
+                                hash_garbled_chunk(*_hash, chunk.garbledTables.data(), chunk.wireMaskShift.data(), chunkSize);
+                            }
+                            {
+                                std::lock_guard lock {_mutex};
+                                _received = chunkIndex + 1;
+                            }
+                            _cv.notify_all();
+                        }
+                    } catch (...) {
+                        {
+                            std::lock_guard lock {_mutex};
+                            _error = std::current_exception();
+                        }
+                        _cv.notify_all();
+                    }
                 }
-                default: {
-                    throw std::runtime_error{"Unexpected gate type"};
+
+                void _advance_to(const size_t chunkIndex) {
+                    std::unique_lock lock {_mutex};
+                    _released = chunkIndex;
+                    _cv.notify_all();
+                    _cv.wait(lock, [this, chunkIndex]() {
+                        return _received > chunkIndex || _error;
+                    });
+                    if (_received <= chunkIndex) {
+                        std::rethrow_exception(_error);
+                    }
+                    _current = &_slots[chunkIndex % _slots.size()];
+                    _currentIndex = chunkIndex;
                 }
+
+            public:
+                // @param hashed whether to hash the chunks for `digest`
+                GarbledChunkReceiver(NetIO& io, const size_t andGateSize, const bool hashed = false):
+                    _io {io},
+                    _andGateSize {andGateSize},
+                    _slots(std::min(GARBLE_RECV_WINDOW, calc_chunk_count(andGateSize)))
+                {
+                    if (hashed) {
+                        _hash.emplace();
+                    }
+                    for (auto& [garbledTables, wireMaskShift] : _slots) {
+                        garbledTables.resize(GARBLE_CHUNK_SIZE);
+                        wireMaskShift.resize(calc_bitset_block(GARBLE_CHUNK_SIZE));
+                    }
+                    _thread = std::thread{&GarbledChunkReceiver::_receive_all, this};
                 }
-            }
 
-            io.send_data(garbledTables.data(), garbledTables.size() * 2 * sizeof(emp::block));
-            const auto rawWireMaskShift {dump_raw_blocks(wireMaskShift)};
-            io.send_data(rawWireMaskShift.data(), rawWireMaskShift.size() * sizeof(BitsetBlock));
+                GarbledChunkReceiver(const GarbledChunkReceiver&) = delete;
+                GarbledChunkReceiver& operator=(const GarbledChunkReceiver&) = delete;
+
+                // If evaluation stopped early, the thread may be blocked in `recv_data` on chunks that never come
+                ~GarbledChunkReceiver() {
+                    bool receiving;
+                    {
+                        std::lock_guard lock {_mutex};
+                        _stopped = true;
+                        receiving = _received != calc_chunk_count(_andGateSize) && !_error;
+                    }
+                    _cv.notify_all();
+                    if (receiving) {
+                        _io.shutdown();
+                    }
+                    _thread.join();
+                }
+
+                static size_t calc_chunk_count(const size_t andGateSize) noexcept {
+                    return (andGateSize + GARBLE_CHUNK_SIZE - 1) / GARBLE_CHUNK_SIZE;
+                }
 
-            return {std::move(label0), std::move(label1), std::move(garbledTables), std::move(wireMaskShift)};
+                const std::array<emp::block, 2>* tables(const size_t k) {
+                    const size_t chunkIndex {k / GARBLE_CHUNK_SIZE};
+                    if (!_current || chunkIndex != _currentIndex) {
+                        _advance_to(chunkIndex);
+                    }
+                    return _current->garbledTables.data() + k % GARBLE_CHUNK_SIZE;
+                }
+
+                // Digest of all chunks, as Garbler::commit_garbled_tables computes it. Only once evaluation is done.
+                GarbledTablesDigest digest() {
+                    std::lock_guard lock {_mutex};
+                    assert(_hash && _received == calc_chunk_count(_andGateSize));
+                    GarbledTablesDigest digest;
+                    _hash->digest(digest.data());
+                    return digest;
+                }
+
+                // `k` must lie in the chunk of the last `tables` call
+                bool wire_mask_shift(const size_t k) const noexcept {
+                    assert(_current && k / GARBLE_CHUNK_SIZE == _currentIndex);
+                    const size_t offset {k % GARBLE_CHUNK_SIZE};
+                    constexpr size_t bitsPerBlock {Bitset::bits_per_block};
+                    return (_current->wireMaskShift[offset / bitsPerBlock] >> (offset % bitsPerBlock)) & 1;
+                }
+            };
         }
-    }
 
-    namespace Evaluator {
         ReceivedGarbledCircuit garble(ATLab::NetIO& io, const Circuit& circuit) {
             GarbledTableVec garbledTables(circuit.andGateSize, {zero_block(), zero_block()});
-
-            io.recv_data(garbledTables.data(), circuit.andGateSize * 2 * sizeof(emp::block));
             std::vector<BitsetBlock> rawWireMaskShift(calc_bitset_block(circuit.andGateSize));
-            io.recv_data(rawWireMaskShift.data(), rawWireMaskShift.size() * sizeof(BitsetBlock));
+
+            for (size_t chunkBegin {0}; chunkBegin < circuit.andGateSize; chunkBegin += GARBLE_CHUNK_SIZE) {
+                const size_t chunkSize {std::min(GARBLE_CHUNK_SIZE, circuit.andGateSize - chunkBegin)};
+                io.recv_data(garbledTables.data() + chunkBegin, chunkSize * 2 * sizeof(emp::block));
+                io.recv_data(
+                    rawWireMaskShift.data() + chunkBegin / Bitset::bits_per_block,
+                    calc_bitset_block(chunkSize) * sizeof(BitsetBlock)
+                );
+            }
             Bitset wireMaskShift {rawWireMaskShift.begin(), rawWireMaskShift.end()};
             wireMaskShift.resize(circuit.andGateSize);
 
@@ -110,75 +517,46 @@ namespace ATLab {
             const PreprocessedData&         wireMasks,
             const ReceivedGarbledCircuit&   garbledCircuit,
             std::vector<emp::block>         labels,
-            Bitset                          maskedValues
+            Bitset                          maskedValues,
+            const size_t                    threadCount
         ) {
-            const auto& masks {wireMasks.masks};
-            const auto& beaverTriples {wireMasks.beaverTripleShares};
-            const auto& garbledTables {garbledCircuit.garbledTables};
-            const auto& wireMaskShift {garbledCircuit.wireMaskShift};
-
-            maskedValues.resize(circuit.wireSize);
-            labels.resize(circuit.wireSize);
-            for (size_t gateIter {0}, andGateIter {0}; gateIter != circuit.gateSize; ++gateIter) {
-                const auto& gate {circuit.gates[gateIter]};
-                switch (gate.type) {
-                case Gate::Type::NOT: {
-                    maskedValues[gate.out] = not maskedValues[gate.in0];
-                    labels[gate.out] = labels[gate.in0];
-                    break;
-                }
-                case Gate::Type::AND: {
-                    emp::block g0 {_mm_xor_si128(
-                        garbledTables[andGateIter][0],
-                        masks.get_mac(0, gate.in1)
-                    )};
-                    emp::block g1 {_mm_xor_si128(
-                        garbledTables[andGateIter][1],
-                        masks.get_mac(0, gate.in0)
-                    )};
-                    xor_to(g1, labels[gate.in0]);
-
-                    // emp::block label {_mm_xor_si128(
-                    //     hash(labels[gate.in0], gate.out, 0),
-                    //     hash(labels[gate.in1], gate.out, 1)
-                    // )};
-                    const emp::block hash0 {hash(labels[gate.in0], gate.out, 0)};
-                    const emp::block hash1 {hash(labels[gate.in1], gate.out, 1)};
-                    emp::block label {_mm_xor_si128(hash0, hash1)};
-                    xor_to(label, masks.get_mac(0, gate.out));
-                    xor_to(label, beaverTriples.get_mac(0, andGateIter));
-                    xor_to(label, and_all_bits(
-                               maskedValues[gate.in0],
-                               // _mm_xor_si128(g0, masks.get_mac(0, gate.in1))
-                               g0
-                           ));
-                    xor_to(label, and_all_bits(
-                               maskedValues[gate.in1],
-                               // _mm_xor_si128(
-                               g1
-                                   // _mm_xor_si128(
-                                   //     masks.get_mac(0, gate.in0),
-                                   //     labels[gate.in0]
-                                   // )
-                               // )
-                           ));
-                    labels[gate.out] = label;
-                    maskedValues[gate.out] = get_LSB(label) ^ wireMaskShift[andGateIter];
-
-                    ++andGateIter;
-                    break;
-                }
-                case Gate::Type::XOR: {
-                    maskedValues[gate.out] = maskedValues[gate.in0] ^ maskedValues[gate.in1];
-                    labels[gate.out] = _mm_xor_si128(labels[gate.in0], labels[gate.in1]);
-                    break;
-                }
-                default: {
-                    throw std::runtime_error{"Unexpected gate type"};
-                }
-                }
+            ReceivedTableSource tables {garbledCircuit};
+            return evaluate_gates(circuit, wireMasks, tables, std::move(labels), std::move(maskedValues), threadCount);
+        }
+
+        EvaluateResult garble_and_evaluate(
+            ATLab::NetIO&                   io,
+            const Circuit&                  circuit,
+            const PreprocessedData&         wireMasks,
+            std::vector<emp::block>         labels,
+            Bitset                          maskedValues,
+            const size_t                    threadCount
+        ) {
+            GarbledChunkReceiver receiver {io, circuit.andGateSize};
+            return evaluate_gates(circuit, wireMasks, receiver, std::move(labels), std::move(maskedValues), threadCount);
+        }
+
+        GarbledTablesDigest recv_garbled_tables_commitment(ATLab::NetIO& io) {
+            GarbledTablesDigest commitment;
+            io.recv_data(commitment.data(), commitment.size());
+            return commitment;
+        }
+
+        EvaluateResult garble_and_evaluate(
+            ATLab::NetIO&                   io,
+            const Circuit&                  circuit,
+            const PreprocessedData&         wireMasks,
+            std::vector<emp::block>         labels,
+            Bitset                          maskedValues,
+            const GarbledTablesDigest&      commitment,
+            const size_t                    threadCount
+        ) {
+            GarbledChunkReceiver receiver {io, circuit.andGateSize, true};
+            auto result {evaluate_gates(circuit, wireMasks, receiver, std::move(labels), std::move(maskedValues), threadCount)};
+            if (receiver.digest() != commitment) {
+                throw std::runtime_error{ERR_MALICIOUS};
             }
-            return {std::move(maskedValues), std::move(labels)};
+            return result;
         }
     }
 }
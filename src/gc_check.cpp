@@ -60,40 +60,42 @@ namespace ATLab {
                 coeff.push_back(sample_challenge_coeff(chalGen));
             }
 
+            // The MAC term of an independent wire is linear in the MACs of the AND inputs it feeds:
+            // coeff * MAC[in1] if it is a source of in0, coeff * MAC[in0] if it is a source of in1
+            std::vector<emp::block> in0Terms(circuit.andGateSize), in1Terms(circuit.andGateSize);
+            for (size_t andOrder {0}; andOrder != circuit.andGateSize; ++andOrder) {
+                const Gate& gate {circuit.and_gate(andOrder)};
+                emp::gfmul(wireMasks.masks.get_mac(0, gate.in1), coeff[andOrder], &in0Terms[andOrder]);
+                emp::gfmul(wireMasks.masks.get_mac(0, gate.in0), coeff[andOrder], &in1Terms[andOrder]);
+            }
+
             emp::block accumulator {zero_block()};
             auto independent_wire_routine = [
                 &circuit,
-                &wireMasks,
-                &coeff,
+                &in0Terms,
+                &in1Terms,
                 &gc,
                 &accumulator
             ](ATLab::NetIO& ioRef, const Wire w) {
-                const auto& gcCheckData {circuit.gc_check_data(w)};
+                const GCCheckRow row {circuit.gc_check_data(w)};
                 emp::block ak1 {zero_block()};
-                for (const auto& [gateIndex, connected] : gcCheckData) {
-                    const auto& gate {circuit.gates[gateIndex]};
-                    emp::block macTerm;
-                    if (connected.to_ulong() == 3) {
-                        macTerm = _mm_xor_si128(
-                            wireMasks.masks.get_mac(0, gate.in0),
-                            wireMasks.masks.get_mac(0, gate.in1)
-                        );
-                    } else if (connected[0]) {
-                        macTerm = wireMasks.masks.get_mac(0, gate.in1);
-                    } else {
-                        macTerm = wireMasks.masks.get_mac(0, gate.in0);
+                for (size_t k {0}; k != row.size(); ++k) {
+                    const uint32_t andOrder {row.andOrders[k]};
+                    if (row.connections[k] & GCCheckRow::GC_CHECK_IN0) {
+                        xor_to(ak1, in0Terms[andOrder]);
+                    }
+                    if (row.connections[k] & GCCheckRow::GC_CHECK_IN1) {
+                        xor_to(ak1, in1Terms[andOrder]);
                     }
-                    emp::block prod;
-                    emp::gfmul(macTerm, coeff[circuit.and_gate_order(gateIndex)], &prod);
-                    xor_to(ak1, prod);
                 }
 
-                const emp::block ck {hash(gc.label0[w], w, 2)};
+                const uint32_t slot {circuit.label_slot(w)};
+                const emp::block ck {hash(gc.label0[slot], w, 2)};
                 xor_to(accumulator, ck);
 
                 emp::block gk {ak1};
                 xor_to(gk, ck);
-                xor_to(gk, hash(gc.label1[w], w, 2));
+                xor_to(gk, hash(gc.label1(slot), w, 2));
 
                 ioRef.send_data(&gk, sizeof(gk));
             };
@@ -159,8 +161,8 @@ namespace ATLab {
             }
 
             emp::block accumulator {zero_block()};
-            auto independent_wire_routine = [&accumulator, &labels, &maskedValues](ATLab::NetIO& ioRef, const Wire w) {
-                xor_to(accumulator, hash(labels[w], w, 2));
+            auto independent_wire_routine = [&circuit, &accumulator, &labels, &maskedValues](ATLab::NetIO& ioRef, const Wire w) {
+                xor_to(accumulator, hash(labels[circuit.label_slot(w)], w, 2));
                 emp::block received {zero_block()};
                 ioRef.recv_data(&received, sizeof(received));
                 if (maskedValues[w]) {
@@ -145,29 +145,31 @@ namespace {
 
         SparseBitMatrix andedMasks {circuit.andGateSize};
         size_t aMatrixIter {circuit.totalInputSize};
-        for (const auto& gate : circuit.gates) {
-            switch (gate.type) {
+        const auto& [types, in0s, in1s, outs] {circuit.gateArrays};
+        for (size_t gateIter {0}; gateIter != circuit.gateSize; ++gateIter) {
+            const Wire in0 {in0s[gateIter]}, in1 {in1s[gateIter]}, out {outs[gateIter]};
+            switch (types[gateIter]) {
             case Gate::Type::NOT:
-                masks[gate.out] = masks[gate.in0];
-                macs[gate.out] = macs[gate.in0];
-                evaluatorMaskKeys[gate.out] = evaluatorMaskKeys[gate.in0];
+                masks[out] = masks[in0];
+                macs[out] = macs[in0];
+                evaluatorMaskKeys[out] = evaluatorMaskKeys[in0];
                 break;
 
             case Gate::Type::AND:
-                masks[gate.out] = aMatrix.at(aMatrixIter);
-                macs[gate.out] = aMatrix.get_mac(compressParam, aMatrixIter);
-                evaluatorMaskKeys[gate.out] = bKeys.get_local_key(0, bKeysIter);
-                if (masks[gate.in0] && masks[gate.in1]) {
-                    andedMasks.set(gate.in0, gate.in1, aMatrixIter - circuit.totalInputSize);
+                masks[out] = aMatrix.at(aMatrixIter);
+                macs[out] = aMatrix.get_mac(compressParam, aMatrixIter);
+                evaluatorMaskKeys[out] = bKeys.get_local_key(0, bKeysIter);
+                if (masks[in0] && masks[in1]) {
+                    andedMasks.set(in0, in1, aMatrixIter - circuit.totalInputSize);
                 }
                 ++aMatrixIter;
                 ++bKeysIter;
                 break;
 
             case Gate::Type::XOR:
-                masks[gate.out] = masks[gate.in0] ^ masks[gate.in1];
-                macs[gate.out] = _mm_xor_si128(macs[gate.in0], macs[gate.in1]);
-                evaluatorMaskKeys[gate.out] = _mm_xor_si128(evaluatorMaskKeys[gate.in0], evaluatorMaskKeys[gate.in1]);
+                masks[out] = masks[in0] ^ masks[in1];
+                macs[out] = _mm_xor_si128(macs[in0], macs[in1]);
+                evaluatorMaskKeys[out] = _mm_xor_si128(evaluatorMaskKeys[in0], evaluatorMaskKeys[in1]);
                 break;
 
             default:
@@ -212,29 +214,31 @@ namespace {
 
         SparseBitMatrix andedMasks {circuit.andGateSize};
         size_t aMatrixIter {circuit.totalInputSize};
-        for (const auto& gate : circuit.gates) {
-            switch (gate.type) {
+        const auto& [types, in0s, in1s, outs] {circuit.gateArrays};
+        for (size_t gateIter {0}; gateIter != circuit.gateSize; ++gateIter) {
+            const Wire in0 {in0s[gateIter]}, in1 {in1s[gateIter]}, out {outs[gateIter]};
+            switch (types[gateIter]) {
             case Gate::Type::NOT:
-                masks[gate.out] = masks[gate.in0];
-                macs[gate.out] = macs[gate.in0];
-                garblerMaskKeys[gate.out] = garblerMaskKeys[gate.in0];
+                masks[out] = masks[in0];
+                macs[out] = macs[in0];
+                garblerMaskKeys[out] = garblerMaskKeys[in0];
                 break;
 
             case Gate::Type::AND:
-                masks[gate.out] = b[bIter];
-                macs[gate.out] = b.get_mac(0, bIter);
-                garblerMaskKeys[gate.out] = aMatrix.get_local_key(compressParam, aMatrixIter);
-                if (masks[gate.in0] && masks[gate.in1]) {
-                    andedMasks.set(gate.in0, gate.in1, aMatrixIter - circuit.totalInputSize);
+                masks[out] = b[bIter];
+                macs[out] = b.get_mac(0, bIter);
+                garblerMaskKeys[out] = aMatrix.get_local_key(compressParam, aMatrixIter);
+                if (masks[in0] && masks[in1]) {
+                    andedMasks.set(in0, in1, aMatrixIter - circuit.totalInputSize);
                 }
                 ++bIter;
                 ++aMatrixIter;
                 break;
 
             case Gate::Type::XOR:
-                masks[gate.out] = masks[gate.in0] ^ masks[gate.in1];
-                macs[gate.out] = _mm_xor_si128(macs[gate.in0], macs[gate.in1]);
-                garblerMaskKeys[gate.out] = _mm_xor_si128(garblerMaskKeys[gate.in0], garblerMaskKeys[gate.in1]);
+                masks[out] = masks[in0] ^ masks[in1];
+                macs[out] = _mm_xor_si128(macs[in0], macs[in1]);
+                garblerMaskKeys[out] = _mm_xor_si128(garblerMaskKeys[in0], garblerMaskKeys[in1]);
                 break;
 
             default:
@@ -312,12 +316,11 @@ BENCHMARK_START
             // 9
             std::vector<emp::block> tmpBeaverTriple(circuit.andGateSize, zero_block()); // \tilde{b_k}
             Bitset tmpBeaverTripleLsb(circuit.andGateSize);
-            for (size_t gateIter {0}, andGateIndex {0}; gateIter != circuit.gateSize; ++gateIter) {
-                const auto& gate {circuit.gates[gateIter]};
-                if (!gate.is_and()) {
-                    continue;
-                }
-                // AND gate
+            const auto& in0s {circuit.gateArrays.in0};
+            const auto& in1s {circuit.gateArrays.in1};
+            for (size_t andGateIndex {0}; andGateIndex != circuit.andGateSize; ++andGateIndex) {
+                const size_t gateIndex {circuit.and_gate_index(andGateIndex)};
+                const Wire in0 {in0s[gateIndex]}, in1 {in1s[gateIndex]};
 
                 // <a_i a_j> ^ <beaver triple share> ^ <a_i b_j> ^ <a_j b_i>
                 emp::block& sum {tmpBeaverTriple[andGateIndex]};
@@ -328,11 +331,10 @@ BENCHMARK_START
                     globalKey.get_alpha_0()
                 ));
 
-                xor_to(sum, ab(gate.in0, gate.in1));
-                xor_to(sum, ab(gate.in1, gate.in0));
+                xor_to(sum, ab(in0, in1));
+                xor_to(sum, ab(in1, in0));
 
                 tmpBeaverTripleLsb.set(andGateIndex, get_LSB(sum));
-                ++andGateIndex;
             }
 
             std::vector<BitsetBlock> rawTmpBeaverTripleLsb {dump_raw_blocks(tmpBeaverTripleLsb)};
@@ -509,23 +511,21 @@ BENCHMARK_START
             // 9
             std::vector<emp::block> tmpBeaverTriple(circuit.andGateSize, zero_block()); // \tilde{b_k}
             Bitset tmpBeaverTripleLsb(circuit.andGateSize);
-            for (size_t gateIter {0}, andGateIndex {0}; gateIter != circuit.gateSize; ++gateIter) {
-                const auto& gate {circuit.gates[gateIter]};
-                if (!gate.is_and()) {
-                    continue;
-                }
-                // AND gate
+            const auto& in0s {circuit.gateArrays.in0};
+            const auto& in1s {circuit.gateArrays.in1};
+            for (size_t andGateIndex {0}; andGateIndex != circuit.andGateSize; ++andGateIndex) {
+                const size_t gateIndex {circuit.and_gate_index(andGateIndex)};
+                const Wire in0 {in0s[gateIndex]}, in1 {in1s[gateIndex]};
 
                 // <a_i a_j> ^ <beaver triple share> ^ <a_i b_j> ^ <a_j b_i>
                 emp::block& sum {tmpBeaverTriple[andGateIndex]};
                 xor_to(sum, garblerAndedMasks.get_local_key(0, andGateIndex));
                 xor_to(sum, beaverTripleKeys.get_local_key(0, andGateIndex));
 
-                xor_to(sum, ab(gate.in0, gate.in1));
-                xor_to(sum, ab(gate.in1, gate.in0));
+                xor_to(sum, ab(in0, in1));
+                xor_to(sum, ab(in1, in0));
 
                 tmpBeaverTripleLsb.set(andGateIndex, get_LSB(sum));
-                ++andGateIndex;
             }
 
             std::vector<BitsetBlock> rawReceivedLsb(tmpBeaverTripleLsb.num_blocks());
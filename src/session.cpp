@@ -0,0 +1,10 @@
+#include "ATLab/session.hpp"
+
+namespace ATLab {
+    Session& NetIO::session() {
+        if (!_session) {
+            _session = std::make_shared<Session>(*this);
+        }
+        return *_session;
+    }
+}
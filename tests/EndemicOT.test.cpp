@@ -34,6 +34,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ATLab/EndemicOT/EndemicOT.hpp>
 #include <ATLab/PRNG.hpp>
 
+extern "C" {
+#include <indcpa.h>
+#include <ATLab/EndemicOT/OTTools.h>
+}
+
 namespace {
     std::ostream& operator<<(std::ostream& out, const ATLab::EndemicOT::DataBlock& data) {
         std::ios store {nullptr};
@@ -175,3 +180,69 @@ TEST(EndemicOT, emp_BatchTest) {
         EXPECT_EQ(d.at(i), choices.at(i) ? d1.at(i) : d0.at(i));
     }
 }
+
+TEST(EndemicOT, template_and_runtime_batches_interoperate) {
+    constexpr size_t NUM_OT {37};
+    std::array<__m128i, NUM_OT> data0 {}, data1 {}, data {};
+    write_random_data(data0);
+    write_random_data(data1);
+    const auto choices {ATLab::random_bool_array<NUM_OT>()};
+
+    std::thread sender {[&]() {
+        ATLab::NetIO io(ATLab::NetIO::CLIENT, IP, PORT + 1, true);
+        ATLab::EndemicOT::batch_send<NUM_OT>(io, data0.data(), data1.data());
+    }}, receiver {[&]() {
+        ATLab::NetIO io(ATLab::NetIO::SERVER, IP, PORT + 1, true);
+        ATLab::EndemicOT::batch_receive(io, data.data(), choices.data(), NUM_OT);
+    }};
+    sender.join();
+    receiver.join();
+
+    for (size_t i {0}; i != NUM_OT; ++i) {
+        const auto& expected {choices[i] ? data1[i] : data0[i]};
+        EXPECT_EQ(ATLab::as_uint128(data[i]), ATLab::as_uint128(expected)) << "OT " << i;
+    }
+}
+
+TEST(EndemicOT, x4_kyber_matches_single_instances) {
+    constexpr size_t WIDTH {4};
+    std::array<std::array<uint8_t, KYBER_SYMBYTES>, WIDTH> keySeeds {}, matrixSeeds {}, coins {};
+    // The AVX2 poly_frommsg loads messages as aligned 32-byte vectors
+    alignas(32) std::array<std::array<uint8_t, KYBER_INDCPA_MSGBYTES>, WIDTH> msgs {};
+    for (size_t l {0}; l != WIDTH; ++l) {
+        write_random_data(keySeeds[l]);
+        write_random_data(matrixSeeds[l]);
+        write_random_data(coins[l]);
+        write_random_data(msgs[l]);
+    }
+
+    std::array<std::array<uint8_t, KYBER_INDCPA_PUBLICKEYBYTES>, WIDTH> pks {}, pksX4 {}, randomPks {}, randomPksX4 {};
+    std::array<std::array<uint8_t, KYBER_INDCPA_SECRETKEYBYTES>, WIDTH> sks {}, sksX4 {};
+    std::array<std::array<uint8_t, KYBER_INDCPA_BYTES>, WIDTH> ctxts {}, ctxtsX4 {};
+    std::array<uint8_t*, WIDTH> pkp {}, skp {}, ctxtp {}, randomPkp {};
+    std::array<const uint8_t*, WIDTH> keySeedp {}, matrixSeedp {}, coinsp {}, msgp {}, pkSeedp {}, pkcp {};
+    for (size_t l {0}; l != WIDTH; ++l) {
+        indcpa_keypair_derand(pks[l].data(), sks[l].data(), keySeeds[l].data());
+        indcpa_enc(ctxts[l].data(), msgs[l].data(), pks[l].data(), coins[l].data());
+        randomPK(randomPks[l].data(), matrixSeeds[l].data(), pks[l].data() + KYBER_POLYVECBYTES);
+
+        pkp[l] = pksX4[l].data();
+        skp[l] = sksX4[l].data();
+        ctxtp[l] = ctxtsX4[l].data();
+        randomPkp[l] = randomPksX4[l].data();
+        keySeedp[l] = keySeeds[l].data();
+        matrixSeedp[l] = matrixSeeds[l].data();
+        coinsp[l] = coins[l].data();
+        msgp[l] = msgs[l].data();
+        pkSeedp[l] = pks[l].data() + KYBER_POLYVECBYTES;
+        pkcp[l] = pks[l].data();
+    }
+    indcpa_keypair_x4_derand(pkp.data(), skp.data(), keySeedp.data());
+    indcpa_enc_x4(ctxtp.data(), msgp.data(), pkcp.data(), coinsp.data());
+    randomPK_x4(randomPkp.data(), matrixSeedp.data(), pkSeedp.data());
+
+    EXPECT_EQ(pksX4, pks);
+    EXPECT_EQ(sksX4, sks);
+    EXPECT_EQ(ctxtsX4, ctxts);
+    EXPECT_EQ(randomPksX4, randomPks);
+}
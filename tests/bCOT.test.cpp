@@ -3,6 +3,7 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include <set>
 
 #include <../include/ATLab/block_correlated_OT.hpp>
 
@@ -144,3 +145,89 @@ TEST(BCOT, MULTI_INSTANCE_REUSES_OT) {
     verify_bcot(keys1, macArr1, choices1, deltaArr1, firstLen);
     verify_bcot(keys2, macArr2, choices2, deltaArr2, secondLen);
 }
+
+TEST(BCOT, CONCURRENT_SESSIONS) {
+    // Every NetIO carries its own session, so independent pairs run side by side in one process
+    constexpr size_t sessionSize {4};
+    constexpr size_t deltaSize {2};
+
+    std::vector<std::vector<emp::block>> deltaArrs(sessionSize, std::vector<emp::block>(deltaSize));
+    auto prng {ATLab::PRNG_Kyber::get_PRNG_Kyber()};
+    for (auto& deltaArr : deltaArrs) {
+        for (auto& delta : deltaArr) {
+            delta = ATLab::as_block(prng());
+        }
+    }
+
+    std::vector<std::vector<emp::block>> keys(sessionSize), macArrs(sessionSize);
+    std::vector<ATLab::Bitset> choices(sessionSize);
+    std::vector<std::thread> threads;
+    for (size_t s {0}; s != sessionSize; ++s) {
+        const auto port {static_cast<unsigned short>(PORT + 2 + s)};
+        threads.emplace_back([&, s, port]() {
+            ATLab::NetIO io(ATLab::NetIO::SERVER, ADDRESS, port, true);
+            ATLab::BlockCorrelatedOT::Sender sender(io, deltaArrs[s]);
+            keys[s] = sender.extend(OT_SIZE);
+        });
+        threads.emplace_back([&, s, port]() {
+            ATLab::NetIO io(ATLab::NetIO::CLIENT, ADDRESS, port, true);
+            ATLab::BlockCorrelatedOT::Receiver receiver(io, deltaSize);
+            auto [c, m] = receiver.extend(OT_SIZE);
+            choices[s] = std::move(c);
+            macArrs[s] = std::move(m);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t s {0}; s != sessionSize; ++s) {
+        ASSERT_EQ(keys[s].size(), deltaSize * OT_SIZE);
+        ASSERT_EQ(macArrs[s].size(), deltaSize * OT_SIZE);
+        verify_bcot(keys[s], macArrs[s], choices[s], deltaArrs[s], OT_SIZE);
+    }
+}
+
+TEST(BCOT, POOLED_REQUESTS) {
+    constexpr size_t deltaSize {2};
+    constexpr unsigned short POOL_PORT {static_cast<unsigned short>(PORT + 6)};
+    // Served from the pool, across a refill, and larger than a pool batch
+    const std::vector<size_t> lengths {40, 128, 1, ATLab::BlockCorrelatedOT::COT_POOL_SIZE, 40, 1900, 300, 5};
+
+    auto prng {ATLab::PRNG_Kyber::get_PRNG_Kyber()};
+    std::vector<emp::block> deltaArr(deltaSize);
+    for (auto& delta : deltaArr) {
+        delta = ATLab::as_block(prng());
+    }
+
+    std::vector<std::vector<emp::block>> keys, macs;
+    std::vector<ATLab::Bitset> choices;
+    std::thread senderThread {[&]() {
+        ATLab::NetIO io(ATLab::NetIO::SERVER, ADDRESS, POOL_PORT, true);
+        const ATLab::BlockCorrelatedOT::Sender sender(io, deltaArr);
+        for (const size_t len : lengths) {
+            keys.push_back(sender.extend(len));
+        }
+    }}, receiverThread {[&]() {
+        ATLab::NetIO io(ATLab::NetIO::CLIENT, ADDRESS, POOL_PORT, true);
+        const ATLab::BlockCorrelatedOT::Receiver receiver(io, deltaSize);
+        for (const size_t len : lengths) {
+            auto [c, m] {receiver.extend(len)};
+            choices.push_back(std::move(c));
+            macs.push_back(std::move(m));
+        }
+    }};
+    senderThread.join();
+    receiverThread.join();
+
+    std::set<__uint128_t> seen;
+    for (size_t call {0}; call != lengths.size(); ++call) {
+        ASSERT_EQ(keys[call].size(), deltaSize * lengths[call]);
+        ASSERT_EQ(choices[call].size(), lengths[call]);
+        verify_bcot(keys[call], macs[call], choices[call], deltaArr, lengths[call]);
+        // no OT is handed out twice
+        for (const auto& key : keys[call]) {
+            ASSERT_TRUE(seen.insert(ATLab::as_uint128(key)).second) << "call " << call;
+        }
+    }
+}
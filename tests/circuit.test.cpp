@@ -2,6 +2,12 @@
 
 #include <../include/ATLab/circuit_parser.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
 #include <vector>
 
 namespace {
@@ -12,6 +18,25 @@ namespace {
         });
         return wires;
     }
+
+    std::vector<char> serialize_array(const std::vector<size_t>& array) {
+        const uint64_t size {array.size()};
+        std::vector<char> bytes(sizeof(size) + array.size() * sizeof(size_t));
+        std::memcpy(bytes.data(), &size, sizeof(size));
+        std::memcpy(bytes.data() + sizeof(size), array.data(), array.size() * sizeof(size_t));
+        return bytes;
+    }
+
+    // Overwrites the serialized `from` array in a binary circuit file with `to` of the same size
+    void corrupt_array(const std::string& file, const std::vector<size_t>& from, const std::vector<size_t>& to) {
+        std::vector<char> bytes(std::filesystem::file_size(file));
+        std::ifstream{file, std::ios::binary}.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        const auto fromBytes {serialize_array(from)}, toBytes {serialize_array(to)};
+        const auto pos {std::search(bytes.begin(), bytes.end(), fromBytes.cbegin(), fromBytes.cend())};
+        ASSERT_NE(pos, bytes.end());
+        std::copy(toBytes.cbegin(), toBytes.cend(), pos);
+        std::ofstream{file, std::ios::binary}.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
 }
 
 TEST(Circuit_Parser, default) {
@@ -70,6 +95,88 @@ TEST(Circuit_Parser, populates_metadata_for_simple_circuit) {
 #ifdef DEBUG
     EXPECT_THROW(auto res {circuit.and_gate_order(4)}, std::exception);
 #endif // DEBUG
+
+    // Source gates and the structure-of-arrays copy
+    ASSERT_EQ(circuit.gateArrays.size(), circuit.gateSize);
+    for (size_t i {0}; i != circuit.gateSize; ++i) {
+        const auto& gate {circuit.gates[i]};
+        EXPECT_EQ(circuit.gate_index_by_output_wire(gate.out), i);
+        EXPECT_EQ(circuit.gateArrays.types[i], gate.type);
+        EXPECT_EQ(circuit.gateArrays.in0[i], gate.in0);
+        EXPECT_EQ(circuit.gateArrays.in1[i], gate.in1);
+        EXPECT_EQ(circuit.gateArrays.out[i], gate.out);
+    }
+    EXPECT_EQ(circuit.and_gate_index(1), 5);
+    EXPECT_EQ(circuit.independent_index_map(2), 2);
+    EXPECT_EQ(circuit.independent_index_map(6), 3);
+    EXPECT_EQ(circuit.independent_index_map(8), 4);
+#ifdef DEBUG
+    EXPECT_THROW(auto res {circuit.gate_index_by_output_wire(1)}, std::out_of_range);
+#endif // DEBUG
+}
+
+TEST(Circuit_Parser, sparse_xor_source_lists) {
+    // Same circuit as above
+    const ATLab::Circuit circuit {"circuits/test_circuit.txt"};
+
+    // Wire 7 = 5 ^ 6 = 0 ^ 2 ^ 6
+    const auto list7 {circuit.xor_source_list(7)};
+    EXPECT_EQ(list7.size(), 3);
+    EXPECT_TRUE(list7.has(0));
+    EXPECT_FALSE(list7.has(1));
+    EXPECT_TRUE(list7.has(2));
+    EXPECT_TRUE(list7.has(6));
+    EXPECT_FALSE(list7.has(8));
+    EXPECT_FALSE(list7.test_flip());
+
+    // NOT gate shares the source list of its input and only flips
+    EXPECT_TRUE(circuit.xor_source_list(9).test_flip());
+    EXPECT_FALSE(circuit.xor_source_list(8).test_flip());
+    EXPECT_EQ(circuit.xor_source_list(9).wires().data(), circuit.xor_source_list(8).wires().data());
+}
+
+TEST(Circuit_Parser, level_schedule) {
+    // Same circuit as above
+    const ATLab::Circuit circuit {"circuits/test_circuit.txt"};
+    auto to_vector {[](const boost::span<const size_t> gates) {
+        return std::vector<size_t>(gates.begin(), gates.end());
+    }};
+
+    ASSERT_EQ(circuit.level_size(), 3);
+    EXPECT_EQ(to_vector(circuit.level(0).linearGates), (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(to_vector(circuit.level(0).andGates), (std::vector<size_t>{3}));
+    EXPECT_EQ(to_vector(circuit.level(1).linearGates), (std::vector<size_t>{4}));
+    EXPECT_EQ(to_vector(circuit.level(1).andGates), (std::vector<size_t>{5}));
+    EXPECT_EQ(to_vector(circuit.level(2).linearGates), (std::vector<size_t>{6}));
+    EXPECT_TRUE(circuit.level(2).andGates.empty());
+
+    std::vector<size_t> scheduledAND;
+    circuit.for_each_scheduled_AND_gate([&](const ATLab::Gate& gate, const size_t scheduleIndex) {
+        EXPECT_EQ(scheduleIndex, scheduledAND.size());
+        scheduledAND.push_back(gate.index);
+    });
+    EXPECT_EQ(scheduledAND, (std::vector<size_t>{3, 5}));
+}
+
+TEST(Circuit_Parser, label_slots) {
+    // Same circuit as above
+    const ATLab::Circuit circuit {"circuits/test_circuit.txt"};
+
+    ASSERT_EQ(circuit.label_slot_size(), 9);
+    for (ATLab::Wire w {0}; w != static_cast<ATLab::Wire>(circuit.totalInputSize); ++w) {
+        EXPECT_EQ(circuit.label_slot(w), w);
+    }
+    // wire 5 is last read by gate 4, which reuses its slot for wire 7
+    EXPECT_EQ(circuit.label_slot(7), circuit.label_slot(5));
+
+    // inputs, AND outputs and outputs are never shared
+    std::set<uint32_t> pinnedSlots;
+    for (const ATLab::Wire w : {0, 1, 2, 6, 8, 9}) {
+        EXPECT_TRUE(pinnedSlots.insert(circuit.label_slot(w)).second);
+    }
+    for (const ATLab::Wire w : {3, 4, 5, 7}) {
+        EXPECT_EQ(pinnedSlots.count(circuit.label_slot(w)), 0);
+    }
 }
 
 TEST(Circuit_Parser, gc_check_data) {
@@ -88,17 +195,17 @@ TEST(Circuit_Parser, gc_check_data) {
     const ATLab::Circuit circuit {"circuits/test_circuit.txt"};
 
     auto test_independent_wire {[&circuit](const ATLab::Wire w) {
-        const auto& gcCheckData {circuit.gc_check_data(w)};
-        for (const auto& [gateIndex, connected] : gcCheckData) {
-            const auto& gate {circuit.gates[gateIndex]};
-
-            EXPECT_NE(connected.to_ulong(), 0);
-            if (connected.test(0)) {
-                EXPECT_TRUE(circuit.xor_source_list(gate.in0).has(w));
-            }
-            if (connected.test(1)) {
-                EXPECT_TRUE(circuit.xor_source_list(gate.in1).has(w));
+        const ATLab::GCCheckRow row {circuit.gc_check_data(w)};
+        for (size_t k {0}; k != row.size(); ++k) {
+            if (k != 0) {
+                EXPECT_LT(row.andOrders[k - 1], row.andOrders[k]);
             }
+            const auto& gate {circuit.and_gate(row.andOrders[k])};
+            const uint8_t connected {row.connections[k]};
+
+            EXPECT_NE(connected, 0);
+            EXPECT_EQ(circuit.xor_source_list(gate.in0).has(w), (connected & ATLab::GCCheckRow::GC_CHECK_IN0) != 0);
+            EXPECT_EQ(circuit.xor_source_list(gate.in1).has(w), (connected & ATLab::GCCheckRow::GC_CHECK_IN1) != 0);
         }
     }};
 
@@ -113,4 +220,106 @@ TEST(Circuit_Parser, gc_check_data) {
         }
         test_independent_wire(gate.out);
     }
+
+    // wire 1 is a source of both inputs of gate 3, wire 6 of both inputs of gate 5
+    const ATLab::GCCheckRow row1 {circuit.gc_check_data(1)};
+    ASSERT_EQ(row1.size(), 1);
+    EXPECT_EQ(row1.andOrders[0], 0);
+    EXPECT_EQ(row1.connections[0], ATLab::GCCheckRow::GC_CHECK_IN0 | ATLab::GCCheckRow::GC_CHECK_IN1);
+    const ATLab::GCCheckRow row6 {circuit.gc_check_data(6)};
+    ASSERT_EQ(row6.size(), 1);
+    EXPECT_EQ(row6.andOrders[0], 1);
+    EXPECT_EQ(row6.connections[0], ATLab::GCCheckRow::GC_CHECK_IN0 | ATLab::GCCheckRow::GC_CHECK_IN1);
+}
+
+TEST(Circuit_Parser, binary_round_trip) {
+    for (const std::string file : {"circuits/test_circuit.txt", "circuits/bristol_format/adder_32bit.txt"}) {
+        const ATLab::Circuit parsed {file};
+        const auto binaryFile {(std::filesystem::temp_directory_path() / "ATLab_round_trip.circuit").string()};
+        parsed.save(binaryFile);
+        const auto loaded {ATLab::Circuit::Load(binaryFile)};
+        std::filesystem::remove(binaryFile);
+
+        ASSERT_EQ(loaded.gateSize, parsed.gateSize);
+        ASSERT_EQ(loaded.wireSize, parsed.wireSize);
+        EXPECT_EQ(loaded.inputSize0, parsed.inputSize0);
+        EXPECT_EQ(loaded.inputSize1, parsed.inputSize1);
+        EXPECT_EQ(loaded.totalInputSize, parsed.totalInputSize);
+        EXPECT_EQ(loaded.outputSize, parsed.outputSize);
+        ASSERT_EQ(loaded.andGateSize, parsed.andGateSize);
+        EXPECT_EQ(loaded.label_slot_size(), parsed.label_slot_size());
+
+        for (size_t i {0}; i != parsed.gateSize; ++i) {
+            const auto &a {loaded.gates[i]}, &b {parsed.gates[i]};
+            EXPECT_EQ(a.type, b.type);
+            EXPECT_EQ(a.in0, b.in0);
+            EXPECT_EQ(a.in1, b.in1);
+            EXPECT_EQ(a.out, b.out);
+            EXPECT_EQ(a.index, b.index);
+            if (b.is_and()) {
+                EXPECT_EQ(loaded.and_gate_order(i), parsed.and_gate_order(i));
+            }
+            EXPECT_EQ(loaded.gate_index_by_output_wire(b.out), i);
+        }
+        for (ATLab::Wire w {0}; w != static_cast<ATLab::Wire>(parsed.wireSize); ++w) {
+            EXPECT_EQ(collectWires(loaded.xor_source_list(w)), collectWires(parsed.xor_source_list(w)));
+            EXPECT_EQ(loaded.xor_source_list(w).test_flip(), parsed.xor_source_list(w).test_flip());
+            EXPECT_EQ(loaded.label_slot(w), parsed.label_slot(w));
+            if (parsed.is_independent(w)) {
+                const auto rowA {loaded.gc_check_data(w)}, rowB {parsed.gc_check_data(w)};
+                EXPECT_TRUE(std::equal(rowA.andOrders.begin(), rowA.andOrders.end(), rowB.andOrders.begin(), rowB.andOrders.end()));
+                EXPECT_TRUE(std::equal(rowA.connections.begin(), rowA.connections.end(), rowB.connections.begin(), rowB.connections.end()));
+            }
+        }
+        ASSERT_EQ(loaded.level_size(), parsed.level_size());
+        for (size_t l {0}; l != parsed.level_size(); ++l) {
+            const auto levelA {loaded.level(l)}, levelB {parsed.level(l)};
+            EXPECT_TRUE(std::equal(levelA.linearGates.begin(), levelA.linearGates.end(), levelB.linearGates.begin(), levelB.linearGates.end()));
+            EXPECT_TRUE(std::equal(levelA.andGates.begin(), levelA.andGates.end(), levelB.andGates.begin(), levelB.andGates.end()));
+        }
+    }
+}
+
+TEST(Circuit_Parser, binary_rejects_malformed_files) {
+    EXPECT_THROW(auto res {ATLab::Circuit::Load("circuits/test_circuit.txt")}, std::runtime_error);
+
+    const ATLab::Circuit circuit {"circuits/test_circuit.txt"};
+    const auto binaryFile {(std::filesystem::temp_directory_path() / "ATLab_truncated.circuit").string()};
+    circuit.save(binaryFile);
+    std::filesystem::resize_file(binaryFile, std::filesystem::file_size(binaryFile) - 8);
+    EXPECT_THROW(auto res {ATLab::Circuit::Load(binaryFile)}, std::runtime_error);
+
+    // Corrupted level schedules and AND orders keep every index in bounds but must still be rejected
+    std::vector<size_t> schedule, andPositions;
+    for (size_t l {0}; l != circuit.level_size(); ++l) {
+        const auto level {circuit.level(l)};
+        schedule.insert(schedule.end(), level.linearGates.begin(), level.linearGates.end());
+        for (const size_t gateIndex : level.andGates) {
+            andPositions.push_back(schedule.size());
+            schedule.push_back(gateIndex);
+        }
+    }
+    ASSERT_GE(andPositions.size(), 2);
+    ASSERT_NE(andPositions.front(), 0);
+    const size_t firstAnd {andPositions[0]}, secondAnd {andPositions[1]};
+    std::vector<size_t> andGateOrder(circuit.gateSize, ATLab::Circuit::AND_ORDER_DISABLED);
+    for (size_t andOrder {0}; andOrder != circuit.andGateSize; ++andOrder) {
+        andGateOrder[circuit.and_gate_index(andOrder)] = andOrder;
+    }
+
+    auto swappedSlices {schedule};
+    std::swap(swappedSlices.front(), swappedSlices[firstAnd]);
+    auto duplicated {schedule};
+    duplicated[secondAnd] = duplicated[firstAnd];
+    auto swappedOrder {andGateOrder};
+    std::swap(swappedOrder[schedule[firstAnd]], swappedOrder[schedule[secondAnd]]);
+    for (const auto& [from, to] : {
+        std::pair{schedule, swappedSlices}, std::pair{schedule, duplicated}, std::pair{andGateOrder, swappedOrder}
+    }) {
+        circuit.save(binaryFile);
+        EXPECT_NO_THROW(auto res {ATLab::Circuit::Load(binaryFile)});
+        corrupt_array(binaryFile, from, to);
+        EXPECT_THROW(auto res {ATLab::Circuit::Load(binaryFile)}, std::runtime_error);
+    }
+    std::filesystem::remove(binaryFile);
 }
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include <../include/ATLab/ferret_cot.hpp>
+
+namespace {
+    const std::string ADDRESS {"127.0.0.1"};
+    constexpr unsigned short PORT {12351};
+
+    // Insecure but small: 8 trees of 2^10 leaves
+    constexpr ATLab::BlockCorrelatedOT::FerretParam TEST_PARAM {8 << 10, 1024, 8, 10};
+}
+
+TEST(Ferret_COT, correlation_across_rounds) {
+    // Spans several rounds, so the reserved outputs are used as the next base
+    constexpr size_t FIRST_LEN {100}, SECOND_LEN {3 * (8 << 10)};
+
+    emp::block delta;
+    std::vector<emp::block> keys(FIRST_LEN + SECOND_LEN), macs(FIRST_LEN + SECOND_LEN);
+    std::unique_ptr<bool[]> choices {new bool[FIRST_LEN + SECOND_LEN]};
+
+    std::thread senderThread {[&]() {
+        ATLab::NetIO io(ATLab::NetIO::SERVER, ADDRESS, PORT, true);
+        ATLab::BlockCorrelatedOT::FerretSender sender {io, TEST_PARAM};
+        sender.send_cot(keys.data(), FIRST_LEN);
+        sender.send_cot(keys.data() + FIRST_LEN, SECOND_LEN);
+        delta = sender.delta();
+        io.flush();
+    }}, receiverThread {[&]() {
+        ATLab::NetIO io(ATLab::NetIO::CLIENT, ADDRESS, PORT, true);
+        ATLab::BlockCorrelatedOT::FerretReceiver receiver {io, TEST_PARAM};
+        receiver.recv_cot(macs.data(), choices.get(), FIRST_LEN);
+        receiver.recv_cot(macs.data() + FIRST_LEN, choices.get() + FIRST_LEN, SECOND_LEN);
+    }};
+    senderThread.join();
+    receiverThread.join();
+
+    size_t ones {0};
+    for (size_t i {0}; i != keys.size(); ++i) {
+        const emp::block expected {choices[i] ? keys[i] ^ delta : keys[i]};
+        ASSERT_EQ(ATLab::as_uint128(expected), ATLab::as_uint128(macs[i])) << "COT " << i;
+        ones += choices[i];
+    }
+    // The choice bits are LPN samples, roughly balanced
+    EXPECT_GT(ones, keys.size() / 3);
+    EXPECT_LT(ones, keys.size() * 2 / 3);
+}
+
+TEST(Ferret_COT, rejects_inconsistent_parameters) {
+    EXPECT_THROW((ATLab::BlockCorrelatedOT::FerretParam{1000, 10, 8, 7}.check()), std::invalid_argument);
+    EXPECT_NO_THROW(TEST_PARAM.check());
+    EXPECT_NO_THROW(ATLab::BlockCorrelatedOT::FerretParam::Default().check());
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <thread>
 
@@ -28,20 +30,22 @@ namespace {
 
     template <size_t N>
     void full_execution_tester(
-        const std::string& circuitFile, const TestType<N>& tests
+        const std::string& circuitFile, const TestType<N>& tests, const size_t threadCount = 1
     ) {
         const Circuit circuit {circuitFile};
         std::array<Bitset, N> outputs;
         std::thread garblerThread{[&](){
             auto& io {server_io()};
             for (size_t i {0}; i != N; ++i) {
-                Garbler::full_protocol(io, circuit, Bitset(circuit.inputSize0, tests[i].input0));
+                Garbler::full_protocol(io, circuit, Bitset(circuit.inputSize0, tests[i].input0), threadCount);
             }
             io.flush();
         }}, evaluatorThread{[&]() {
             auto& io {client_io()};
             for (size_t i {0}; i != N; ++i) {
-                outputs[i] = Evaluator::full_protocol(io, circuit, Bitset(circuit.inputSize1, tests[i].input1));
+                outputs[i] = Evaluator::full_protocol(
+                    io, circuit, Bitset(circuit.inputSize1, tests[i].input1), threadCount
+                );
             }
             io.flush();
         }};
@@ -110,42 +114,89 @@ namespace {
         };
     }
 
+    // Input labels under zero label0 and global key 1
+    std::vector<emp::block> zero_input_labels(const Bitset& inputs) {
+        std::vector<emp::block> labels(inputs.size(), zero_block());
+        for (size_t i {0}; i != inputs.size(); ++i) {
+            if (inputs[i]) {
+                labels[i] = _mm_set_epi64x(0, 1);
+            }
+        }
+        return labels;
+    }
+
+    Bitset output_bits(const Circuit& circuit, const Bitset& maskedValues) {
+        Bitset result(circuit.outputSize);
+        for (size_t i = 0; i < circuit.outputSize; ++i) {
+            result[i] = maskedValues[maskedValues.size() - circuit.outputSize + i];
+        }
+        return result;
+    }
+
     Bitset zero_evaluate_execute(
         const Circuit& circuit,
         const Evaluator::ReceivedGarbledCircuit& gc,
         Bitset input0,
-        const Bitset& input1
+        const Bitset& input1,
+        const size_t threadCount = 1
     ) {
-        auto one_block {[]() {
-            return _mm_set_epi64x(0, 1);
-        }};
-
         Bitset inputs {merge(std::move(input0), input1)};
-
-        std::vector<emp::block> labels(inputs.size(), zero_block());
-        for (size_t i {0}; i != inputs.size(); ++i) {
-            if (inputs[i]) {
-                labels[i] = one_block();
-            }
-        }
+        std::vector<emp::block> labels {zero_input_labels(inputs)};
 
         const auto garbledResults {Evaluator::evaluate(
             circuit,
             gen_pre_data_zero<Evaluator::PreprocessedData>(circuit),
             gc,
             std::move(labels),
-            std::move(inputs)
+            std::move(inputs),
+            threadCount
         )};
 
-        // return the last circuit.outputSize bits in garbledResults.maskedValues
-        Bitset result(circuit.outputSize);
-        for (size_t i = 0; i < circuit.outputSize; ++i) {
-            result[i] = garbledResults.maskedValues[garbledResults.maskedValues.size() - circuit.outputSize + i];
+        return output_bits(circuit, garbledResults.maskedValues);
+    }
+
+    // Like zero_tester, but evaluating while the garbled tables are streamed
+    template <size_t N>
+    void zero_pipelined_tester(
+        const std::string& circuitFile,
+        const TestType<N>& tests,
+        const size_t threadCount = 1
+    ) {
+        const Circuit circuit {circuitFile};
+        for (size_t i {0}; i < tests.size(); ++i) {
+            Bitset inputs {merge(Bitset{circuit.inputSize0, tests[i].input0}, Bitset{circuit.inputSize1, tests[i].input1})};
+            Bitset result;
+            std::thread garblerThread{[&](){
+                auto& io {server_io()};
+                Garbler::garble(
+                    io,
+                    circuit,
+                    gen_pre_data_zero<Garbler::PreprocessedData>(circuit),
+                    {circuit.totalInputSize, zero_block()},
+                    threadCount
+                );
+                io.flush();
+            }}, evaluatorThread{[&]() {
+                auto& io {client_io()};
+                const auto garbledResults {Evaluator::garble_and_evaluate(
+                    io,
+                    circuit,
+                    gen_pre_data_zero<Evaluator::PreprocessedData>(circuit),
+                    zero_input_labels(inputs),
+                    inputs,
+                    threadCount
+                )};
+                result = output_bits(circuit, garbledResults.maskedValues);
+            }};
+            garblerThread.join();
+            evaluatorThread.join();
+
+            EXPECT_EQ(result.to_ulong(), tests[i].output)
+                << ", where i = " << i << " of circuit " << circuitFile << '\n';
         }
-        return result;
     }
 
-    Evaluator::ReceivedGarbledCircuit gen_zero_gc(const Circuit& circuit) {
+    Evaluator::ReceivedGarbledCircuit gen_zero_gc(const Circuit& circuit, const size_t threadCount = 1) {
         Evaluator::ReceivedGarbledCircuit gc;
 
         std::thread garblerThread{[&](){
@@ -154,7 +205,8 @@ namespace {
                 io,
                 circuit,
                 gen_pre_data_zero<Garbler::PreprocessedData>(circuit),
-                {circuit.totalInputSize, zero_block()}
+                {circuit.totalInputSize, zero_block()},
+                threadCount
             );
 
             io.flush();
@@ -174,11 +226,12 @@ namespace {
     template <size_t N>
     void zero_tester(
         const std::string& circuitFile,
-        const TestType<N>& tests
+        const TestType<N>& tests,
+        const size_t threadCount = 1
     ) {
         const Circuit circuit {circuitFile};
 
-        const auto gc {gen_zero_gc(circuit)};
+        const auto gc {gen_zero_gc(circuit, threadCount)};
 
         for (size_t i {0}; i < tests.size(); ++i) {
             EXPECT_EQ(
@@ -186,7 +239,8 @@ namespace {
                     circuit,
                     gc,
                     Bitset{circuit.inputSize0, tests[i].input0},
-                    Bitset{circuit.inputSize1, tests[i].input1}
+                    Bitset{circuit.inputSize1, tests[i].input1},
+                    threadCount
                 ).to_ulong(),
                 tests[i].output
             ) << ", where i = " << i << " of circuit " << circuitFile << '\n';
@@ -214,6 +268,32 @@ namespace {
         }
     }
 
+    // A chain of `andGateSize` AND gates computing in0 & in1, written as a Bristol circuit file
+    std::string write_AND_chain_circuit(const size_t andGateSize) {
+        const auto path {std::filesystem::temp_directory_path() / "ATLab-AND-chain.txt"};
+        std::ofstream fout {path};
+        fout << andGateSize << ' ' << andGateSize + 2 << "\n1 1 1\n\n";
+        for (size_t i {0}; i != andGateSize; ++i) {
+            fout << "2 1 " << (i == 0 ? 0 : i + 1) << " 1 " << i + 2 << " AND\n";
+        }
+        return path.string();
+    }
+
+    // `andGateSize` (odd) parallel AND gates of in0 & in1, XORed together into the output
+    std::string write_AND_fan_circuit(const size_t andGateSize) {
+        const auto path {std::filesystem::temp_directory_path() / "ATLab-AND-fan.txt"};
+        std::ofstream fout {path};
+        fout << 2 * andGateSize - 1 << ' ' << 2 * andGateSize + 1 << "\n1 1 1\n\n";
+        for (size_t i {0}; i != andGateSize; ++i) {
+            fout << "2 1 0 1 " << i + 2 << " AND\n";
+        }
+        // wire andGateSize + 1 + i holds the XOR of the first i + 1 AND outputs
+        for (size_t i {1}; i != andGateSize; ++i) {
+            fout << "2 1 " << (i == 1 ? 2 : andGateSize + i) << ' ' << i + 2 << ' ' << andGateSize + i + 1 << " XOR\n";
+        }
+        return path.string();
+    }
+
     constexpr TestType<4> andTests {{
         {0, 0, 0},
         {0, 1, 0},
@@ -255,12 +335,142 @@ TEST(execution, full) {
     full_execution_tester("circuits/bristol_format/adder_32bit.txt", adderTests);
 }
 
+#ifdef BCOT_BACKEND_FERRET
+// Preprocessing on the Ferret COT backend, with its consistency check
+TEST(execution, ferret_backend) {
+    full_execution_tester("circuits/one-gate-AND.txt", andTests);
+    full_execution_tester("circuits/bristol_format/adder_32bit.txt", adderTests);
+}
+#endif // BCOT_BACKEND_FERRET
+
+// Pins the garbling transcript: a change of the hash, its tweak layout or the table format fails here
+TEST(execution, zero_labels_garbled_tables_known_answer) {
+    const Circuit circuit {"circuits/test_circuit.txt"};
+    const auto gc {gen_zero_gc(circuit)};
+
+#ifdef GARBLE_HASH_SHA256
+    const std::array<std::array<emp::block, 2>, 2> expectedTables {{
+        {emp::makeBlock(0x2e1d298a6b0894e8, 0xd3ce2ac4cb92d526), emp::makeBlock(0x83e7fcacf2099b22, 0xd540518ba398666a)},
+        {emp::makeBlock(0xd4315c0a41a5439c, 0xa7e15759245ab7cd), emp::makeBlock(0x92fcad79b8c4aa09, 0x0a378c5fb7ef96b7)}
+    }};
+    constexpr unsigned long expectedWireMaskShift {0};
+#else
+    const std::array<std::array<emp::block, 2>, 2> expectedTables {{
+        {emp::makeBlock(0xa31e0854fdce98d9, 0xf983d17bafa519ad), emp::makeBlock(0xa2945c73b0771a78, 0x5936eaaad1b4096e)},
+        {emp::makeBlock(0x4b494262eb7ea466, 0x14fcce13809accb9), emp::makeBlock(0x50c17c76464ae118, 0xd05c829a92366f39)}
+    }};
+    constexpr unsigned long expectedWireMaskShift {3};
+#endif // GARBLE_HASH_SHA256
+
+    ASSERT_EQ(gc.garbledTables.size(), expectedTables.size());
+    for (size_t i {0}; i != expectedTables.size(); ++i) {
+        for (size_t j {0}; j != 2; ++j) {
+            EXPECT_EQ(as_uint128(gc.garbledTables[i][j]), as_uint128(expectedTables[i][j])) << "table " << i << ", row " << j;
+        }
+    }
+    EXPECT_EQ(gc.wireMaskShift.to_ulong(), expectedWireMaskShift);
+}
+
 // Setting masks, Label0 to zero, global keys to 1
 TEST(execution, zero_labels) {
     zero_tester("circuits/one-gate-AND.txt", andTests);
     zero_tester("circuits/one-gate-XOR.txt", xorTests);
     zero_tester("circuits/one-gate-NOT.txt", notTests);
     zero_tester("circuits/bristol_format/adder_32bit.txt", adderTests);
+    zero_pipelined_tester("circuits/bristol_format/adder_32bit.txt", adderTests);
+}
+
+// More garbled-table chunks than the evaluator window, with a partial last chunk
+TEST(execution, chunked_garbled_tables) {
+    const std::string circuitFile {write_AND_chain_circuit((ATLab::GARBLE_RECV_WINDOW + 1) * ATLab::GARBLE_CHUNK_SIZE + 3)};
+    zero_tester(circuitFile, andTests);
+    zero_pipelined_tester(circuitFile, andTests);
+    std::filesystem::remove(circuitFile);
+}
+
+// Evaluation throws while the receiving thread waits for a chunk that is never sent: the error must surface, not hang
+TEST(execution, pipelined_evaluation_error) {
+    const std::string circuitFile {write_AND_chain_circuit(2 * ATLab::GARBLE_CHUNK_SIZE)};
+    const Circuit circuit {circuitFile}, otherCircuit {"circuits/one-gate-AND.txt"};
+    // its own connection, as the failed evaluation shuts it down
+    constexpr unsigned short ALT_PORT {static_cast<unsigned short>(PORT + 1)};
+
+    std::thread garblerThread{[&]() {
+        ATLab::NetIO io(ATLab::NetIO::SERVER, ADDRESS, ALT_PORT, true);
+        const GarbledTableVec garbledTables(ATLab::GARBLE_CHUNK_SIZE, {zero_block(), zero_block()});
+        io.send_data(garbledTables.data(), garbledTables.size() * 2 * sizeof(emp::block));
+        send_boost_bitset(io, Bitset(ATLab::GARBLE_CHUNK_SIZE));
+        io.flush();
+        // the evaluator gives up and closes the connection instead of waiting for the second chunk
+        char byte;
+        EXPECT_ANY_THROW(io.recv_data(&byte, 1));
+    }}, evaluatorThread{[&]() {
+        ATLab::NetIO io(ATLab::NetIO::CLIENT, ADDRESS, ALT_PORT, true);
+        Bitset inputs(circuit.totalInputSize);
+        // preprocessed for a smaller circuit: the masks of the second AND gate are out of range
+        EXPECT_THROW(
+            static_cast<void>(Evaluator::garble_and_evaluate(
+                io,
+                circuit,
+                gen_pre_data_zero<Evaluator::PreprocessedData>(otherCircuit),
+                zero_input_labels(inputs),
+                inputs
+            )),
+            std::out_of_range
+        );
+    }};
+    garblerThread.join();
+    evaluatorThread.join();
+    std::filesystem::remove(circuitFile);
+}
+
+// Tables garbled after the commitment under other input labels are rejected
+TEST(execution, garbled_tables_commitment) {
+    const Circuit circuit {"circuits/bristol_format/adder_32bit.txt"};
+    for (const bool honest : {true, false}) {
+        std::thread garblerThread{[&]() {
+            auto& io {server_io()};
+            const auto wireMasks {gen_pre_data_zero<Garbler::PreprocessedData>(circuit)};
+            const std::vector<emp::block> label0(circuit.totalInputSize, zero_block());
+            Garbler::commit_garbled_tables(io, circuit, wireMasks, label0);
+            auto garbledLabel0 {label0};
+            if (!honest) {
+                garbledLabel0.back() = _mm_set_epi64x(0, 2);
+            }
+            Garbler::garble(io, circuit, wireMasks, std::move(garbledLabel0));
+            io.flush();
+        }}, evaluatorThread{[&]() {
+            auto& io {client_io()};
+            Bitset inputs(circuit.totalInputSize);
+            const auto commitment {Evaluator::recv_garbled_tables_commitment(io)};
+            auto evaluate {[&]() {
+                return Evaluator::garble_and_evaluate(
+                    io,
+                    circuit,
+                    gen_pre_data_zero<Evaluator::PreprocessedData>(circuit),
+                    zero_input_labels(inputs),
+                    inputs,
+                    commitment
+                );
+            }};
+            if (honest) {
+                EXPECT_EQ(output_bits(circuit, evaluate().maskedValues).to_ulong(), 0);
+            } else {
+                EXPECT_THROW(static_cast<void>(evaluate()), std::runtime_error);
+            }
+        }};
+        garblerThread.join();
+        evaluatorThread.join();
+    }
+}
+
+// A level wider than a chunk, garbled and evaluated by several threads
+TEST(execution, multithreaded_levels) {
+    const std::string circuitFile {write_AND_fan_circuit(ATLab::GARBLE_CHUNK_SIZE + 1001)};
+    zero_tester(circuitFile, andTests, 4);
+    zero_pipelined_tester(circuitFile, andTests, 3);
+    std::filesystem::remove(circuitFile);
+    full_execution_tester("circuits/bristol_format/adder_32bit.txt", adderTests, 4);
 }
 
 TEST(AES, zero_labels) {
@@ -272,3 +482,4 @@ TEST(AES, full_execution) {
     std::cout.flush();
     full_execution_tester_large("circuits/bristol_format/AES-non-expanded.txt", aesTest);
 }
+
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "ATLab/fixed_key_aes.hpp"
+#include "ATLab/garble_evaluate.hpp"
+
+namespace {
+    emp::block load_bytes(const std::array<uint8_t, 16>& bytes) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data()));
+    }
+
+    bool block_eq(const emp::block& a, const emp::block& b) {
+        return _mm_testz_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, b));
+    }
+}
+
+TEST(Garble_Hash, fixed_key_AES_known_answer) {
+    // FIPS-197, Appendix C.1
+    const ATLab::FixedKeyAES aes {load_bytes({
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    })};
+    const emp::block plaintext {load_bytes({
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    })};
+    const emp::block expected {load_bytes({
+        0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+    })};
+    EXPECT_TRUE(block_eq(aes.encrypt(plaintext), expected));
+}
+
+TEST(Garble_Hash, sigma_is_linear_orthomorphism) {
+    const emp::block x {_mm_set_epi64x(0x0123456789abcdefLL, 0x0fedcba987654321LL)};
+    const emp::block y {_mm_set_epi64x(0x1111222233334444LL, 0x5555666677778888LL)};
+
+    // σ(x_L || x_R) = (x_L ⊕ x_R) || x_L
+    EXPECT_TRUE(block_eq(
+        ATLab::sigma(x),
+        _mm_set_epi64x(0x0123456789abcdefLL ^ 0x0fedcba987654321LL, 0x0123456789abcdefLL)
+    ));
+    EXPECT_TRUE(block_eq(
+        ATLab::sigma(_mm_xor_si128(x, y)),
+        _mm_xor_si128(ATLab::sigma(x), ATLab::sigma(y))
+    ));
+    // σ(x) ⊕ x is also a permutation, in particular non-zero on non-zero input
+    EXPECT_FALSE(block_eq(_mm_xor_si128(ATLab::sigma(x), x), ATLab::zero_block()));
+}
+
+TEST(Garble_Hash, deterministic_and_tweak_separated) {
+    const emp::block label {_mm_set_epi64x(0x243F6A8885A308D3LL, 0x13198A2E03707344LL)};
+
+    // Both parties must derive the same value from the same label and tweak
+    EXPECT_TRUE(block_eq(ATLab::hash(label, 7, 0), ATLab::hash(label, 7, 0)));
+
+    EXPECT_FALSE(block_eq(ATLab::hash(label, 7, 0), ATLab::hash(label, 7, 1)));
+    EXPECT_FALSE(block_eq(ATLab::hash(label, 7, 0), ATLab::hash(label, 8, 0)));
+    EXPECT_FALSE(block_eq(ATLab::hash(label, 7, 2), ATLab::hash(_mm_xor_si128(label, _mm_set_epi64x(0, 1)), 7, 2)));
+}
+
+TEST(Garble_Hash, known_answer) {
+    // Independent of the implementation: TMMO with AES-128 under the fixed key, or SHA-256(label || tweak)
+    // truncated to 128 bits, with the tweak (w, pad) as the high and low 64-bit halves
+    const emp::block label {_mm_set_epi64x(0x243F6A8885A308D3LL, 0x13198A2E03707344LL)};
+    struct KnownAnswer {
+        emp::block label;
+        ATLab::Wire w;
+        int pad;
+        emp::block expected;
+    };
+    const std::array<KnownAnswer, 4> answers {{
+#ifdef GARBLE_HASH_SHA256
+        {label, 7, 0, emp::makeBlock(0x541abdbc9d4502e2, 0xc965cb352d141559)},
+        {label, 7, 1, emp::makeBlock(0x88d65eb401322785, 0xda84115ad9d45f71)},
+        {ATLab::zero_block(), 0, 0, emp::makeBlock(0x208e9f8e8bc18f6c, 0x77bd62f8ad7a6866)},
+        {label, 0x7fffffff, 3, emp::makeBlock(0xd88265fe2165552f, 0xad25b44e4747faa3)},
+#else
+        {label, 7, 0, emp::makeBlock(0x4a8d0e8a9b31cdb4, 0xdd1378bcc926b13e)},
+        {label, 7, 1, emp::makeBlock(0x203b65bd12910645, 0xaed936b3a2f5c4c4)},
+        {ATLab::zero_block(), 0, 0, emp::makeBlock(0x201ca8c3fcb0188c, 0x13bdc35eee179aed)},
+        {label, 0x7fffffff, 3, emp::makeBlock(0x70b0b4008c04e3e4, 0x460cb0fd86949d01)},
+#endif // GARBLE_HASH_SHA256
+    }};
+    for (const auto& [x, w, pad, expected] : answers) {
+        EXPECT_TRUE(block_eq(ATLab::hash(x, w, pad), expected)) << "w = " << w << ", pad = " << pad;
+        EXPECT_TRUE(block_eq(ATLab::hash_tweaked(x, ATLab::garble_tweak(w, pad)), expected));
+        emp::block batched;
+        const emp::block tweak {ATLab::garble_tweak(w, pad)};
+        ATLab::hash_batch(&x, &tweak, &batched, 1);
+        EXPECT_TRUE(block_eq(batched, expected));
+    }
+}
+
+TEST(Garble_Hash, batch_matches_single) {
+    // Lengths around the AES-NI and VAES widths and the hash batch size
+    for (const size_t n : {size_t{1}, size_t{7}, size_t{8}, size_t{17}, size_t{32}, size_t{77}}) {
+        std::vector<emp::block> labels(n), tweaks(n), batched(n);
+        for (size_t i {0}; i != n; ++i) {
+            labels[i] = _mm_set_epi64x(static_cast<int64_t>(i * 0x9E3779B97F4A7C15ULL), static_cast<int64_t>(n + i));
+            tweaks[i] = ATLab::garble_tweak(static_cast<ATLab::Wire>(i), static_cast<int>(i % 2));
+        }
+
+        std::vector<emp::block> encrypted {labels};
+        ATLab::FixedKeyAES::Get_instance().encrypt_batch(encrypted.data(), n);
+        ATLab::hash_batch(labels.data(), tweaks.data(), batched.data(), n);
+        for (size_t i {0}; i != n; ++i) {
+            EXPECT_TRUE(block_eq(encrypted[i], ATLab::FixedKeyAES::Get_instance().encrypt(labels[i])))
+                << "n = " << n << ", i = " << i;
+            EXPECT_TRUE(block_eq(batched[i], ATLab::hash(labels[i], static_cast<ATLab::Wire>(i), static_cast<int>(i % 2))))
+                << "n = " << n << ", i = " << i;
+        }
+    }
+}
@@ -1,9 +1,15 @@
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
 #include <sstream>
+#include <thread>
+#include <vector>
 
+#include "../include/ATLab/net-io.hpp"
 #include "../include/ATLab/utils.hpp"
 
 TEST(Utils, PrintByte) {
@@ -24,3 +30,133 @@ TEST(Utils, PrintByte) {
 
     ATLab::print_bytes(buf);
 }
+
+TEST(NetIO, mixed_sizes_round_trip) {
+    constexpr unsigned short PORT {12361};
+    // Smaller than, equal to, and several times the socket buffer
+    const std::vector<size_t> sizes {1, 7, 4096, ATLab::NETWORK_BUFFER_SIZE - 3, ATLab::NETWORK_BUFFER_SIZE, 3,
+        3 * ATLab::NETWORK_BUFFER_SIZE + 5, 16};
+    std::vector<std::vector<uint8_t>> payloads;
+    for (size_t i {0}; i != sizes.size(); ++i) {
+        std::vector<uint8_t> payload(sizes[i]);
+        std::iota(payload.begin(), payload.end(), static_cast<uint8_t>(i * 31));
+        payloads.push_back(std::move(payload));
+    }
+
+    std::vector<std::vector<uint8_t>> echoed(payloads.size());
+    std::thread server {[&]() {
+        ATLab::NetIO io {ATLab::NetIO::SERVER, "127.0.0.1", PORT, true};
+        for (const auto& payload : payloads) {
+            io.send_data(payload.data(), payload.size());
+        }
+        for (size_t i {0}; i != payloads.size(); ++i) {
+            echoed[i].resize(sizes[i]);
+            io.recv_data(echoed[i].data(), sizes[i]);
+        }
+    }}, client {[&]() {
+        ATLab::NetIO io {ATLab::NetIO::CLIENT, "127.0.0.1", PORT, true};
+        std::vector<std::vector<uint8_t>> received(payloads.size());
+        for (size_t i {0}; i != sizes.size(); ++i) {
+            received[i].resize(sizes[i]);
+            io.recv_data(received[i].data(), sizes[i]);
+        }
+        for (const auto& payload : received) {
+            io.send_data(payload.data(), payload.size());
+        }
+        io.flush();
+    }};
+    server.join();
+    client.join();
+
+    EXPECT_EQ(echoed, payloads);
+}
+
+TEST(NetIO, send_bool_wire_format) {
+    constexpr unsigned short PORT {12362};
+    constexpr size_t LENGTH {1000 * 8 + 5};
+    std::unique_ptr<bool[]> bools {new bool[LENGTH]};
+    for (size_t i {0}; i != LENGTH; ++i) {
+        bools[i] = (i * 7 + i / 3) % 5 < 2;
+    }
+
+    // Reference format: bool 8k + j in bit j of byte k, then the tail one bool per byte
+    std::vector<uint8_t> expectedWire(LENGTH / 8 + LENGTH % 8, 0);
+    for (size_t i {0}; i != LENGTH / 8 * 8; ++i) {
+        expectedWire[i / 8] |= static_cast<uint8_t>(bools[i] << (i % 8));
+    }
+    for (size_t i {LENGTH / 8 * 8}; i != LENGTH; ++i) {
+        expectedWire[LENGTH / 8 + i % 8] = bools[i];
+    }
+
+    std::vector<uint8_t> wire(expectedWire.size());
+    std::unique_ptr<bool[]> received {new bool[LENGTH]};
+    std::thread server {[&]() {
+        ATLab::NetIO io {ATLab::NetIO::SERVER, "127.0.0.1", PORT, true};
+        io.send_bool(bools.get(), LENGTH);
+        io.send_bool(bools.get(), LENGTH);
+        io.flush();
+    }}, client {[&]() {
+        ATLab::NetIO io {ATLab::NetIO::CLIENT, "127.0.0.1", PORT, true};
+        io.recv_data(wire.data(), wire.size());
+        io.recv_bool(received.get(), LENGTH);
+    }};
+    server.join();
+    client.join();
+
+    EXPECT_EQ(wire, expectedWire);
+    for (size_t i {0}; i != LENGTH; ++i) {
+        ASSERT_EQ(received[i], bools[i]) << "bool " << i;
+    }
+}
+
+TEST(NetIO, listener_serves_concurrent_connections) {
+    constexpr size_t CLIENT_SIZE {4};
+    ATLab::NetIOListener listener {"127.0.0.1", 0};
+    ASSERT_NE(listener.port, 0);
+
+    // Every connection is served by its own thread while the listener keeps accepting
+    std::vector<uint64_t> served(CLIENT_SIZE, 0);
+    std::thread acceptor {[&]() {
+        std::vector<std::thread> handlers;
+        for (size_t i {0}; i != CLIENT_SIZE; ++i) {
+            handlers.emplace_back([&served, io = std::shared_ptr<ATLab::NetIO>{listener.accept()}]() {
+                uint64_t id;
+                io->recv_data(&id, sizeof(id));
+                served[id] = id * id;
+                io->send_data(&served[id], sizeof(uint64_t));
+                io->flush();
+            });
+        }
+        for (auto& handler : handlers) {
+            handler.join();
+        }
+    }};
+
+    std::vector<uint64_t> replies(CLIENT_SIZE, 0);
+    std::vector<std::thread> clients;
+    for (uint64_t id {0}; id != CLIENT_SIZE; ++id) {
+        clients.emplace_back([&, id]() {
+            ATLab::NetIO io {ATLab::NetIO::CLIENT, "127.0.0.1", listener.port, true};
+            io.send_data(&id, sizeof(id));
+            io.flush();
+            io.recv_data(&replies[id], sizeof(uint64_t));
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    acceptor.join();
+
+    for (uint64_t id {0}; id != CLIENT_SIZE; ++id) {
+        EXPECT_EQ(replies[id], id * id);
+        EXPECT_EQ(served[id], id * id);
+    }
+
+    // close wakes up a blocked accept
+    std::thread blocked {[&]() {
+        EXPECT_THROW(static_cast<void>(listener.accept()), std::runtime_error);
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    listener.close();
+    blocked.join();
+}
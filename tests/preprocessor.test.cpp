@@ -94,3 +94,71 @@ TEST(Preprocess, DEFAULT) {
     preprocess_test("circuits/test_circuit.txt");
     preprocess_test("circuits/bristol_format/adder_32bit.txt");
 }
+
+TEST(Preprocess, ab_calculator_matches_pairwise_sum) {
+    const ATLab::Circuit circuit {"circuits/bristol_format/adder_32bit.txt"};
+    const size_t
+        independentSize {circuit.independent_size()},
+        rowSize {circuit.andGateSize + circuit.inputSize1},
+        compressParam {8};
+
+    ATLab::Matrix<bool> matrix {rowSize, compressParam};
+    for (auto& block : matrix.data) {
+        block = ATLab::THE_GLOBAL_PRNG() & ((1ULL << compressParam) - 1);
+    }
+    auto random_blocks {[](const size_t size) {
+        std::vector<emp::block> blocks(size);
+        ATLab::THE_GLOBAL_PRNG.random_block(blocks.data(), size);
+        return blocks;
+    }};
+    ATLab::Bitset aBits(independentSize);
+    for (size_t i {0}; i != independentSize; ++i) {
+        aBits.set(i, ATLab::THE_GLOBAL_PRNG() & 1);
+    }
+    const ATLab::ITMacBits aMatrix {aBits, random_blocks(independentSize * compressParam)};
+    const ATLab::ITMacBitKeys aKeys {random_blocks(independentSize * compressParam), random_blocks(compressParam)};
+    const ATLab::ITMacBlockKeys dualAuthedB {random_blocks(rowSize), ATLab::zero_block()};
+
+    for (const bool isGarbler : {true, false}) {
+        ATLab::DualKeyAuthed_ab_Calculator ab {isGarbler ?
+            ATLab::DualKeyAuthed_ab_Calculator{circuit, matrix, aMatrix, dualAuthedB} :
+            ATLab::DualKeyAuthed_ab_Calculator{circuit, matrix, aKeys}
+        };
+
+        // <b_j a_i> = M_j · (macs or keys of a_i) ⊕ a_i α_j, for independent wires i and j
+        auto single {[&](const ATLab::Wire i, const ATLab::Wire j) {
+            if (j < static_cast<ATLab::Wire>(circuit.inputSize0)) {
+                return ATLab::zero_block();
+            }
+            const size_t
+                col {circuit.independent_index_map(i)},
+                row {circuit.independent_index_map(j) - circuit.inputSize0};
+            std::vector<emp::block> column;
+            for (size_t k {0}; k != compressParam; ++k) {
+                column.push_back(isGarbler ? aMatrix.get_mac(k, col) : aKeys.get_local_key(k, col));
+            }
+            emp::block res {matrix.row(row) * column};
+            if (isGarbler) {
+                ATLab::xor_to(res, ATLab::and_all_bits(aBits[col], dualAuthedB.get_local_key(0, row)));
+            }
+            return res;
+        }};
+
+        // The factorized operator() must match the pairwise sum
+        auto pairwise {[&](const ATLab::Wire in0, const ATLab::Wire in1) {
+            emp::block res {ATLab::zero_block()};
+            circuit.xor_source_list(in0).for_each_wire([&](const ATLab::Wire i) {
+                circuit.xor_source_list(in1).for_each_wire([&](const ATLab::Wire j) {
+                    ATLab::xor_to(res, single(i, j));
+                });
+            });
+            return res;
+        }};
+
+        circuit.for_each_AND_gate([&](const ATLab::Gate& gate, size_t) {
+            for (const auto& [a, b] : {std::pair{gate.in0, gate.in1}, std::pair{gate.in1, gate.in0}}) {
+                EXPECT_EQ(ATLab::as_uint128(ab(a, b)), ATLab::as_uint128(pairwise(a, b)));
+            }
+        });
+    }
+}
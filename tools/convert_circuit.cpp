@@ -0,0 +1,40 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <ATLab/circuit_parser.hpp>
+
+// Converts a Bristol-format circuit into the binary format read by `ATLab::Circuit::Load`
+int main(const int argc, const char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <bristol circuit> <binary circuit>\n";
+        return 1;
+    }
+    const std::string input {argv[1]}, output {argv[2]};
+
+    try {
+        const auto parseStart {std::chrono::steady_clock::now()};
+        const ATLab::Circuit circuit {input};
+        const auto parseEnd {std::chrono::steady_clock::now()};
+        circuit.save(output);
+
+        // Reload to make sure the file is readable before it is deployed
+        const auto loadStart {std::chrono::steady_clock::now()};
+        const auto loaded {ATLab::Circuit::Load(output)};
+        const auto loadEnd {std::chrono::steady_clock::now()};
+
+        using std::chrono::milliseconds, std::chrono::duration_cast;
+        std::cout << input << ": " << circuit.gateSize << " gates, " << circuit.andGateSize << " AND gates, "
+            << circuit.wireSize << " wires\n"
+            << "parsed in " << duration_cast<milliseconds>(parseEnd - parseStart).count() << " ms, "
+            << "binary loaded in " << duration_cast<milliseconds>(loadEnd - loadStart).count() << " ms\n";
+        if (loaded.gateSize != circuit.gateSize || loaded.wireSize != circuit.wireSize) {
+            std::cerr << "Reloaded circuit does not match\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}